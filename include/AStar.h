@@ -1,5 +1,13 @@
 #pragma once
 #include "Types.h"
 #include "Grid.h"
+#include "Risk.h"
 #include <vector>
-std::vector<IVec2> aStarPath(const Grid& g, IVec2 start, IVec2 goal, const std::vector<float>& risk, float alpha);
+// expanded, if given, receives the number of nodes popped from the open list
+std::vector<IVec2> aStarPath(const Grid& g, IVec2 start, IVec2 goal, const RiskMap& risk, float alpha, int* expanded = nullptr);
+// Same search confined to the inclusive rectangle [lo, hi]; used for local path refinement
+std::vector<IVec2> aStarPathInRect(const Grid& g, IVec2 start, IVec2 goal, const RiskMap& risk, float alpha, IVec2 lo, IVec2 hi, int* expanded = nullptr);
+// The same two, writing into path (cleared first) so a caller that keeps the
+// vector reuses its storage
+void aStarPath(const Grid& g, IVec2 start, IVec2 goal, const RiskMap& risk, float alpha, std::vector<IVec2>& path, int* expanded = nullptr);
+void aStarPathInRect(const Grid& g, IVec2 start, IVec2 goal, const RiskMap& risk, float alpha, IVec2 lo, IVec2 hi, std::vector<IVec2>& path, int* expanded = nullptr);
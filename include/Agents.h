@@ -75,7 +75,7 @@ struct Warrior : Agent {
 
     void revive(int healAmount) override {
         if (!incapacitated) return;
-        if (reviveCount >= kMaxWarriorRevives) {
+        if (reviveCount >= tunables().maxWarriorRevives) {
             // Exceeded revive limit: convert to permanently dead
             alive = false;
             incapacitated = false;
@@ -0,0 +1,4 @@
+#pragma once
+
+// Headless micro-benchmarks: ai_battle --bench <suite> [args...]
+int runBench(int argc, char* argv[]);
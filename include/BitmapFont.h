@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Built-in 3x5 pixel font for ASCII 32..126 (lower case is drawn as upper
+// case), baked into one small atlas so text is just more textured quads.
+constexpr int  kFontW = 3;
+constexpr int  kFontH = 5;
+constexpr int  kFontAdvance = kFontW + 1;   // per character, in font pixels
+constexpr int  kFontLine = kFontH + 1;      // per line
+
+// Five rows of three bits, top row in the highest octal digit; a set bit
+// is ink, the left column the highest bit of its row
+std::uint16_t fontGlyph(char c);
+
+// All glyphs in a 16 x 6 grid of kFontAdvance x kFontLine cells (one per
+// character from 32 to 127). Cell 127 is solid, so untextured quads can
+// sample it and share the atlas texture with text.
+struct FontAtlas {
+    static constexpr int kCols = 16;
+    static constexpr int kWidth = kCols * kFontAdvance;
+    static constexpr int kHeight = 6 * kFontLine;
+
+    std::vector<std::uint8_t> alpha;    // kWidth x kHeight, 255 = ink
+
+    FontAtlas();
+
+    // Texture coordinates of a character's kFontW x kFontH pixels
+    static void uv(char c, float& u0, float& v0, float& u1, float& v1);
+    // Centre of the solid cell
+    static constexpr float kSolidU = (15 * kFontAdvance + 1.5f) / kWidth;
+    static constexpr float kSolidV = (5 * kFontLine + 2.5f) / kHeight;
+};
+
+// Fixed-capacity text line for per-frame labels and the HUD: appends
+// strings and numbers without allocating; anything past the capacity is
+// dropped
+struct TextLine {
+    char text[96];
+    int len{ 0 };
+
+    TextLine() { text[0] = '\0'; }
+    TextLine& operator<<(const char* s);
+    TextLine& operator<<(char c);
+    TextLine& operator<<(int v);
+    // v with a fixed number of decimals (at most 3)
+    TextLine& fixed(double v, int decimals);
+};
@@ -1,13 +1,15 @@
 ﻿#pragma once
 #include "Types.h"
 #include "Grid.h"
+#include <array>
 #include <vector>
 #include <cmath>
 #include <algorithm>
 
 struct BulletTrail {
-    float x, y;
+    float x = 0, y = 0;
     float life = 1.0f;
+    BulletTrail() = default;
     BulletTrail(float X, float Y) : x(X), y(Y) {}
 };
 
@@ -18,7 +20,10 @@ struct Bullet {
     bool alive = true;
     int damage = 20;
     int bounces = 2;
-    std::vector<BulletTrail> trail;
+    // Last kBulletTrailLength positions, oldest first; stored inline so
+    // bullets never allocate
+    std::array<BulletTrail, kBulletTrailLength> trail;
+    int trailLength = 0;
 
     Bullet(float sx, float sy, float tx, float ty);
     void update(const Grid& g);
@@ -14,4 +14,13 @@ struct Camera {
     void addZoom(float z) {
         zoom = std::clamp(zoom + z, 0.25f, 4.0f);
     }
+
+    // World rect on screen when the projection spans worldW x worldH units
+    // at zoom 1: the view is scaled by zoom after moving (x, y) to the corner
+    void visibleRect(float worldW, float worldH, float& x0, float& y0, float& x1, float& y1) const {
+        x0 = x;
+        y0 = y;
+        x1 = x + worldW / zoom;
+        y1 = y + worldH / zoom;
+    }
 };
@@ -0,0 +1,112 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+
+// Per-cell data of a W x H map stored in kChunkSize x kChunkSize chunks that
+// are allocated on first write. Unallocated chunks read as the layer's fill
+// value, so memory follows the area that is actually in use rather than
+// the map size. Copies are deep. reset() keeps the storage of dropped chunks
+// for later ensure() calls, so a layer rebuilt every tick stops allocating.
+template <typename T>
+class ChunkedLayer {
+public:
+    ChunkedLayer() = default;
+    ChunkedLayer(int w, int h, T fill)
+        : w(w), h(h)
+        , cw((w + kChunkSize - 1) >> kChunkShift)
+        , ch((h + kChunkSize - 1) >> kChunkShift)
+        , fill(fill)
+        , chunks(cw * ch) {}
+
+    ChunkedLayer(const ChunkedLayer& o) : w(o.w), h(o.h), cw(o.cw), ch(o.ch), fill(o.fill), chunks(o.chunks.size()) {
+        for (std::size_t c = 0; c < chunks.size(); ++c)
+            if (o.chunks[c]) {
+                chunks[c].reset(new T[kChunkCells]);
+                std::copy(o.chunks[c].get(), o.chunks[c].get() + kChunkCells, chunks[c].get());
+            }
+    }
+    ChunkedLayer& operator=(const ChunkedLayer& o) {
+        if (this != &o) *this = ChunkedLayer(o);
+        return *this;
+    }
+    ChunkedLayer(ChunkedLayer&&) = default;
+    ChunkedLayer& operator=(ChunkedLayer&&) = default;
+
+    // As if freshly constructed, but keeping the chunk storage for reuse
+    void reset(int nw, int nh, T nfill) {
+        for (auto& c : chunks)
+            if (c) spare.push_back(std::move(c));
+        w = nw;
+        h = nh;
+        cw = (w + kChunkSize - 1) >> kChunkShift;
+        ch = (h + kChunkSize - 1) >> kChunkShift;
+        fill = nfill;
+        chunks.resize(cw * ch);
+    }
+
+    // Keeps storage for n chunks in all, so ensure() and reset() do not
+    // allocate while at most n chunks are awake
+    void reserve(int n) {
+        spare.reserve(n);
+        for (int have = allocatedChunks() + (int)spare.size(); have < n; ++have)
+            spare.emplace_back(new T[kChunkCells]);
+    }
+
+    static constexpr int kChunkCells = kChunkSize * kChunkSize;
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int chunkCount() const { return (int)chunks.size(); }
+    int chunksAcross() const { return cw; }
+    T fillValue() const { return fill; }
+    bool empty() const { return chunks.empty(); }
+
+    static int local(int x, int y) { return ((y & (kChunkSize - 1)) << kChunkShift) | (x & (kChunkSize - 1)); }
+    int chunkOf(int x, int y) const { return (y >> kChunkShift) * cw + (x >> kChunkShift); }
+
+    T at(int x, int y) const {
+        const T* c = chunks[chunkOf(x, y)].get();
+        return c ? c[local(x, y)] : fill;
+    }
+    T at(IVec2 p) const { return at(p.x, p.y); }
+
+    // nullptr while the chunk is unallocated
+    const T* chunk(int c) const { return chunks[c].get(); }
+    T* chunk(int c) { return chunks[c].get(); }
+
+    // Allocates the chunk filled with the fill value if it has no storage yet
+    T* ensure(int c, bool* created = nullptr) {
+        bool make = !chunks[c];
+        if (make) {
+            if (spare.empty()) {
+                chunks[c].reset(new T[kChunkCells]);
+            } else {
+                chunks[c] = std::move(spare.back());
+                spare.pop_back();
+            }
+            std::fill(chunks[c].get(), chunks[c].get() + kChunkCells, fill);
+        }
+        if (created) *created = make;
+        return chunks[c].get();
+    }
+
+    int allocatedChunks() const {
+        return (int)std::count_if(chunks.begin(), chunks.end(), [](const std::unique_ptr<T[]>& c) { return c != nullptr; });
+    }
+
+    // Map rectangle covered by chunk c, clipped to the map
+    void chunkRect(int c, IVec2& lo, IVec2& hi) const {
+        lo = { (c % cw) << kChunkShift, (c / cw) << kChunkShift };
+        hi = { std::min(lo.x + kChunkSize, w) - 1, std::min(lo.y + kChunkSize, h) - 1 };
+    }
+
+private:
+    int w{ 0 }, h{ 0 };
+    int cw{ 0 }, ch{ 0 };
+    T fill{};
+    std::vector<std::unique_ptr<T[]>> chunks;
+    std::vector<std::unique_ptr<T[]>> spare;    // storage freed by reset(), not copied
+};
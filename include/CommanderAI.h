@@ -5,8 +5,14 @@
 #include "AStar.h"
 #include "BFS.h"
 #include "Risk.h"
+#include "Scheduler.h"
+#include "PathService.h"
+#include "SafeField.h"
+#include "TickArena.h"
+#include "Events.h"
 
 #include <vector>
+#include <sstream>
 
 enum class OrderType { Attack, Defend, Heal, Resupply, Move };
 
@@ -15,6 +21,53 @@ struct Order {
     IVec2 target;
 };
 
+// Route a far warrior follows between re-plans (level of detail)
+struct WarriorRoute {
+    Warrior* owner{ nullptr };
+    std::vector<IVec2> path;
+    std::size_t next{ 0 };      // index of the owner's cell on path
+    int planned{ 0 };           // tick the route was planned
+};
+
+// Per-team AI memory that survives between ticks
+struct CommanderState {
+    AgentScheduler sched;
+    int healWatch;      // medic dispatch scan
+    int resupplyWatch;  // porter dispatch scan
+
+    // Risk map is reused while the enemy positions it was built from are unchanged
+    std::vector<IVec2> riskSpots;
+    RiskMap risk;
+    RiskMap riskNext;                // rebuilt into, then swapped with risk
+    bool riskValid{ false };
+
+    std::vector<WarriorRoute> routes;   // indexed like the warrior list
+
+    // Retreat targets of the critically hurt warriors
+    SafeField warriorSafe;
+
+    PathService paths;
+
+    // Memory for what lives only through this team's step
+    TickArena arena;
+
+    // Events of this team's step, published by Game in team order
+    std::vector<GameEvent> events;
+
+    // Diagnostic text of this team's step, flushed by Game after its events
+    // (streamed out through rdbuf(), so it is read as well as written).
+    // Nothing is formatted into it when quiet.
+    std::stringstream log;
+    bool quiet{ false };
+
+    CommanderState()
+        : healWatch(sched.subscribe(eventBit(AgentEvent::DamageTaken)))
+        , resupplyWatch(sched.subscribe(eventBit(AgentEvent::AmmoDepleted) |
+                                        eventBit(AgentEvent::CooldownExpired) |
+                                        eventBit(AgentEvent::Revived)))
+    {}
+};
+
 struct CommanderAI {
     static void step(const Grid& g,
         Commander& c,
@@ -22,5 +75,6 @@ struct CommanderAI {
         Medic& med,
         Porter& port,
         const std::vector<IVec2>& enemySpots,
-        int tick = 0);
+        int tick = 0,
+        CommanderState* state = nullptr);
 };
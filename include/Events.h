@@ -0,0 +1,183 @@
+#pragma once
+#include "Types.h"
+#include "Scenario.h"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// What happens in a battle, as typed records instead of console text. The
+// simulation publishes plain-data events into the game's ring; sinks that
+// subscribed to them format, count or store them when the ring is dispatched.
+// With no console sink subscribed (quiet runs) nothing is ever formatted.
+//
+//   GameEvent e = GameEvent::make(GameEventType::Explosion, tick);
+//   e.explosion = { gx, gy, radius };
+//   game.events.publish(e);
+
+enum class GameEventType : std::uint8_t {
+    Shot = 0,           // a bullet was fired
+    Hit,                // a bullet hit a unit still standing
+    GrenadeThrown,
+    Explosion,
+    Death,              // a unit went down to 0 HP
+    MedicDispatched,
+    Heal,
+    Revive,
+    Resupply,
+    Census,             // warriors still alive, every 50 ticks
+    NoCombat,           // nobody fired on a tick that is a multiple of 100
+    GameOver,
+    Count
+};
+
+constexpr std::uint32_t eventBit(GameEventType e) { return 1u << (unsigned)e; }
+constexpr std::uint32_t kAllGameEvents = (1u << (unsigned)GameEventType::Count) - 1;
+
+const char* roleName(Role r);
+
+// Who took part; positions are cells (IVec2 is not trivially copyable)
+struct EventUnit {
+    Team team;
+    Role role;
+    std::int16_t x, y;
+};
+
+enum class GameOverReason : std::uint8_t {
+    CommanderDown,      // the loser is the team whose commander died
+    Stalemate,          // nothing changed for 500 ticks
+    Timeout,            // tick 5000 reached
+    Overrun             // stepped past the timeout
+};
+
+struct ShotEvent { EventUnit shooter; std::int16_t tx, ty; };
+struct HitEvent { EventUnit shooter, victim; std::int16_t hp; };                // hp after the hit
+struct GrenadeEvent { EventUnit thrower; std::int16_t tx, ty, distance; };
+struct ExplosionEvent { float x, y, radius; };
+struct DeathEvent { EventUnit unit; bool permanent; };                          // else a warrior that can be revived
+struct MedicEvent { EventUnit medic, patient; std::int16_t hp; };               // patient's hp
+struct ResupplyEvent { EventUnit porter, warrior; std::int32_t nextTick; };
+struct CensusEvent { std::int16_t blue, orange; bool header; };                 // header: the 500-tick banner
+struct GameOverEvent {
+    GameOverReason reason;
+    bool draw;
+    Team winner;
+    std::int16_t blueWarriors, orangeWarriors;
+    std::int32_t blueHP, orangeHP;
+};
+
+struct GameEvent {
+    GameEventType type;
+    std::int32_t tick;
+    union {
+        ShotEvent shot;
+        HitEvent hit;
+        GrenadeEvent grenade;
+        ExplosionEvent explosion;
+        DeathEvent death;
+        MedicEvent medic;           // MedicDispatched, Heal, Revive
+        ResupplyEvent resupply;
+        CensusEvent census;
+        GameOverEvent over;
+    };
+
+    static GameEvent make(GameEventType t, int tick)
+    {
+        GameEvent e{};
+        e.type = t;
+        e.tick = tick;
+        return e;
+    }
+};
+static_assert(std::is_trivially_copyable_v<GameEvent>, "events are copied as bytes into the ring and the binary log");
+
+inline EventUnit eventUnit(Team t, Role r, IVec2 p) { return { t, r, (std::int16_t)p.x, (std::int16_t)p.y }; }
+
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void onEvent(const GameEvent& e) = 0;
+};
+
+// Fixed ring of the last kEventRing events plus the sinks fed from it.
+// publish() only copies the record; dispatch() hands what was published
+// since the last dispatch to the sinks, in order (a full ring is dispatched
+// early, so nothing is lost). Single threaded: the AI stages its events and
+// Game publishes them in team order.
+class EventBus {
+public:
+    void subscribe(EventSink& sink, std::uint32_t mask = kAllGameEvents);
+    void unsubscribe(EventSink& sink);
+    bool subscribed(const EventSink& sink) const;
+
+    void publish(const GameEvent& e)
+    {
+        if (published - dispatched == (std::uint64_t)kEventRing) dispatch();
+        ring[(std::size_t)(published & (kEventRing - 1))] = e;
+        published++;
+    }
+    void dispatch();
+
+    // Sequence numbers count from 0; at() is null once seq has been
+    // overwritten or before it is published
+    std::uint64_t count() const { return published; }
+    const GameEvent* at(std::uint64_t seq) const;
+
+private:
+    struct Subscription {
+        EventSink* sink;
+        std::uint32_t mask;
+    };
+
+    std::array<GameEvent, kEventRing> ring{};
+    std::uint64_t published{ 0 }, dispatched{ 0 };
+    std::vector<Subscription> sinks;
+};
+
+// The battle as console text, the lines the game used to print itself
+class ConsoleEventSink : public EventSink {
+public:
+    explicit ConsoleEventSink(std::ostream& os) : os(os) {}
+    void onEvent(const GameEvent& e) override;
+
+    static constexpr std::uint32_t kMask = kAllGameEvents & ~eventBit(GameEventType::Shot) & ~eventBit(GameEventType::Death);
+
+private:
+    std::ostream& os;
+};
+
+// Writes e's console line(s) to os; Shot and Death have none
+void printEvent(std::ostream& os, const GameEvent& e);
+
+// Feeds the event counters of Metrics.h
+class MetricsEventSink : public EventSink {
+public:
+    void onEvent(const GameEvent& e) override;
+};
+
+// Raw records behind a small header, readable by replayEventLog. The layout
+// is this build's GameEvent, so logs move between runs, not between builds
+// for other platforms.
+class BinaryEventLog : public EventSink {
+public:
+    BinaryEventLog() = default;
+    ~BinaryEventLog() override { close(); }
+    BinaryEventLog(const BinaryEventLog&) = delete;
+    BinaryEventLog& operator=(const BinaryEventLog&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    bool close();   // false if a write failed
+    void onEvent(const GameEvent& e) override;
+
+    std::uint64_t written() const { return records; }
+
+private:
+    std::FILE* file{ nullptr };
+    std::uint64_t records{ 0 };
+};
+
+// Publishes every event of a binary log into bus and dispatches it
+bool replayEventLog(const std::string& path, EventBus& bus, std::string& error);
@@ -0,0 +1,29 @@
+#pragma once
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Non-owning reference to a callable: a pointer to it plus a function that
+// calls it. Unlike std::function it never allocates, so lambdas of any size
+// can be handed to hot-path helpers. Only valid while the callable lives,
+// which for a parameter means the duration of the call.
+template <typename Sig>
+class FunctionRef;
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+public:
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, FunctionRef>>>
+    FunctionRef(F&& f)
+        : obj(const_cast<void*>(static_cast<const void*>(std::addressof(f))))
+        , call([](void* o, Args... args) -> R {
+              return (*static_cast<std::remove_reference_t<F>*>(o))(std::forward<Args>(args)...);
+          })
+    {}
+
+    R operator()(Args... args) const { return call(obj, std::forward<Args>(args)...); }
+
+private:
+    void* obj;
+    R (*call)(void*, Args...);
+};
@@ -4,6 +4,8 @@
 #include "Agents.h"
 #include "Bullets.h"
 #include "CommanderAI.h"
+#include "Scenario.h"
+#include "Events.h"
 
 #include <vector>
 #include <optional>
@@ -29,15 +31,28 @@ struct TeamState {
     Medic medic;
     Porter porter;
     Team team;
+    CommanderState ai;
 
-    TeamState(Team t, const Grid& g,
-        IVec2 cpos, IVec2 w1, IVec2 w2, IVec2 mp, IVec2 pp)
-        : commander(t, cpos)
-        , warriors{ Warrior(t, w1), Warrior(t, w2) }
-        , medic(t, mp)
-        , porter(t, pp)
+    TeamState(Team t, const Scenario& s)
+        : commander(t, s.spawn(t, Role::Commander))
+        , medic(t, s.spawn(t, Role::Medic))
+        , porter(t, s.spawn(t, Role::Porter))
         , team(t)
-    {}
+    {
+        for (auto& u : s.units) {
+            if (u.team != t) continue;
+            Agent* a = &commander;
+            if (u.role == Role::Warrior) {
+                warriors.emplace_back(t, u.pos);
+                a = &warriors.back();
+            }
+            else if (u.role == Role::Medic) a = &medic;
+            else if (u.role == Role::Porter) a = &porter;
+            a->hp = u.stats.hp;
+            a->ammo = u.stats.ammo;
+            a->grenades = u.stats.grenades;
+        }
+    }
 };
 
 struct Game {
@@ -50,13 +65,47 @@ struct Game {
 
     bool running{ true };
     int tick{ 0 };
+    std::string logLine;    // logPositionsTick's buffer
+    std::ofstream detailLog;    // game_log.txt, for logDetailedState
+    std::vector<IVec2> spotsForBlue, spotsForOrange;    // enemySpots of this tick
+
+    // Shots that landed this tick, applied once both teams have fired
+    struct PendingHit {
+        TeamState* shooterTeam;
+        const Warrior* shooter;
+        TeamState* victimTeam;
+        Agent* victim;
+    };
+    std::vector<PendingHit> pendingHits;
+
+    // Stalemate detection: the counts at the last change and ticks since
+    int lastBlueWarriors{ 0 }, lastOrangeWarriors{ 0 };
+    int lastBlueHP{ 0 }, lastOrangeHP{ 0 };
+    int stalemateTicks{ 0 };
+
+    // Shots, hits, deaths, the outcome and the rest, dispatched at the end of
+    // every step. The console and metrics sinks are subscribed from the
+    // start; subscribe more (a BinaryEventLog) before stepping.
+    EventBus events;
+    ConsoleEventSink console;
+    MetricsEventSink eventMetrics;
+
+    // Units start where the scenario puts them, with its stats (validate it
+    // and apply its tunables first)
+    Game(const Grid& g, const Scenario& s);
+    // The bus points at the sinks above
+    Game(const Game&) = delete;
+    Game& operator=(const Game&) = delete;
 
-    Game(const Grid& g, const GameConfig& config = GameConfig::Balanced());
+    // Quiet games print nothing and format no text: the console sink is
+    // unsubscribed and the AI writes no diagnostics
+    void setQuiet(bool quiet);
 
     void step();
     void logDetailedState();
     void logPositionsTick(); // NEW: log every agent position each tick (high granularity)
 
-    std::vector<IVec2> enemySpots(Team t) const;
+    // Positions of t's enemies, commander first; out is overwritten
+    void enemySpots(Team t, std::vector<IVec2>& out) const;
     Agent* findAgentAt(Team t, IVec2 p);
 };
@@ -2,6 +2,11 @@
 #include "Types.h"
 #include <vector>
 #include <string>
+#include <memory>
+
+struct HpaLayout;
+struct Landmarks;
+struct JpsRuns;
 
 struct Grid {
     int w{ 0 }, h{ 0 };
@@ -10,6 +15,16 @@ struct Grid {
     IVec2 blueAmmo{ 1,1 }, blueMed{ 1,2 };
     IVec2 orangeAmmo{ 0,0 }, orangeMed{ 0,0 };
 
+    // Static cover multiplier per cell for the risk map (see buildCoverMap)
+    std::vector<float> cover;
+
+    // Hierarchical path-finding abstraction, only built for large maps
+    std::shared_ptr<const HpaLayout> hpa;
+    // Landmark distances for the A* heuristic, absent on very large maps
+    std::shared_ptr<const Landmarks> landmarks;
+    // Vertical run lengths for jump point search, absent on very large maps
+    std::shared_ptr<const JpsRuns> jpsRuns;
+
     bool inBounds(IVec2 p) const {
         return p.x >= 0 && p.y >= 0 && p.x < w && p.y < h;
     }
@@ -37,5 +52,12 @@ struct Grid {
             t == Tile::Water);
     }
 
+    // Text map; falls back to a small built-in map when the file is missing
     static Grid loadFromTxt(const std::string& path);
+    // Binary .aimap maps by extension (see MapFile.h), anything else as text
+    static Grid load(const std::string& path);
+    // Builds whatever derived layers g should have but lacks (cover, HPA*,
+    // JPS runs, landmarks); the loaders call it, generated maps need it too.
+    // A non-empty landmarkCache is a "<map>.landmarks" file to reuse.
+    static void buildDerived(Grid& g, const std::string& landmarkCache = std::string());
 };
@@ -0,0 +1,54 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include "Risk.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+// Hierarchical path-finding (HPA*) abstraction of a Grid.
+// The map is cut into square clusters; entrance nodes sit on both sides of
+// every open stretch of cluster border. Built once at map load and shared.
+struct HpaLayout {
+    int clusterSize{ 0 };
+    int cw{ 0 }, ch{ 0 };                        // clusters across / down
+
+    std::vector<IVec2> nodes;                    // entrance cells
+    std::vector<int> nodeCluster;
+    std::vector<int> nodeLocal;                  // index inside its cluster's node list
+    std::vector<std::vector<int>> clusterNodes;
+    std::vector<std::vector<int>> inter;         // neighbour entrance across a border
+
+    // Intra-cluster edge (i -> j) of cluster c lives at slot clusterSlot[c] + i * k + j,
+    // k = clusterNodes[c].size()
+    std::vector<int> clusterSlot;
+    int slotCount{ 0 };
+
+    int clusterOf(IVec2 p) const {
+        return (p.y / clusterSize) * cw + p.x / clusterSize;
+    }
+
+    void clusterRect(const Grid& g, int c, IVec2& lo, IVec2& hi) const {
+        lo = { (c % cw) * clusterSize, (c / cw) * clusterSize };
+        hi = { std::min(lo.x + clusterSize, g.w) - 1, std::min(lo.y + clusterSize, g.h) - 1 };
+    }
+};
+
+std::shared_ptr<const HpaLayout> buildHpaLayout(const Grid& g, int clusterSize = kHpaClusterSize);
+
+// Intra-cluster edge costs of one team under its risk layer, at a fixed
+// planning alpha. refresh() only recomputes clusters whose risk changed.
+struct HpaCosts {
+    float alpha{ 0.3f };
+    std::vector<float> cost;        // per slot, infinity when unreachable
+    RiskMap riskSeen;               // layer the costs were computed from
+    int lastRefreshed{ 0 };         // clusters recomputed by the last refresh
+
+    void refresh(const Grid& g, const HpaLayout& L, const RiskMap& risk);
+};
+
+// Long-range query: search the abstract graph, then refine every hop with a
+// local A* inside one cluster. Falls back to flat A* if the abstract search fails.
+std::vector<IVec2> hpaPath(const Grid& g, const HpaLayout& L, const HpaCosts& costs,
+                           IVec2 start, IVec2 goal,
+                           const RiskMap& risk, float alpha);
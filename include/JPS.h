@@ -0,0 +1,31 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include "Risk.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Per-map lookup for vertical runs: the number of steps from a cell, moving
+// down or up, to the next cell that is blocked or where a sideways turn is
+// forced. Turns the vertical scans of the search into O(1) lookups.
+struct JpsRuns {
+    std::vector<std::uint16_t> down, up;
+};
+
+std::shared_ptr<const JpsRuns> buildJpsRuns(const Grid& g);
+
+// Jump point search for 4-connected grids where every step costs the same.
+// Canonical paths go horizontally first; a vertical run only turns where a
+// wall behind it forces the turn, so open fields expand a handful of jump
+// points instead of every cell. Confined to the inclusive rectangle [lo, hi];
+// returns just {start} when the goal cannot be reached inside it.
+// Uses g.jpsRuns when the map has them. expanded, if given, receives the
+// number of jump points popped.
+std::vector<IVec2> jpsPath(const Grid& g, IVec2 start, IVec2 goal, IVec2 lo, IVec2 hi, int* expanded = nullptr);
+// Writes into path (cleared first), reusing its storage
+void jpsPath(const Grid& g, IVec2 start, IVec2 goal, IVec2 lo, IVec2 hi, std::vector<IVec2>& path, int* expanded = nullptr);
+
+// True when every passable cell of [lo, hi] carries the same risk, i.e.
+// risk-weighted step costs are uniform there and jpsPath gives optimal paths
+bool riskFlat(const Grid& g, const RiskMap& risk, IVec2 lo, IVec2 hi);
@@ -0,0 +1,47 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+// ALT (A*, landmarks, triangle inequality) heuristic data of a Grid.
+// For a few landmarks spread far apart we store the exact number of steps
+// to every cell. Every step costs at least 1, so for any landmark L
+// |d(L,a) - d(L,b)| never exceeds the cost of walking from a to b.
+struct Landmarks {
+    // Distances at or above kFar are unknown (other component or too far for 16 bits)
+    static constexpr std::uint16_t kFar = 0xFFFF;
+
+    int w{ 0 }, h{ 0 };
+    int count{ 0 };
+    std::vector<IVec2> points;
+    std::vector<std::uint16_t> dist;    // interleaved: dist[cell * count + i]
+    // Set instead of dist when the distances are read in place from a .aimap
+    // mapping; keepAlive holds the mapping open
+    const std::uint16_t* mapped{ nullptr };
+    std::shared_ptr<const void> keepAlive;
+
+    const std::uint16_t* row(int cell) const { return (mapped ? mapped : dist.data()) + cell * count; }
+
+    // Best triangle-inequality lower bound between a cell and a target row
+    int lowerBound(int cell, const std::uint16_t* target) const {
+        const std::uint16_t* a = row(cell);
+        int best = 0;
+        for (int i = 0; i < count; ++i) {
+            if (a[i] == kFar || target[i] == kFar) continue;
+            best = std::max(best, std::abs(int(a[i]) - int(target[i])));
+        }
+        return best;
+    }
+};
+
+// Picks landmarks by farthest-point sampling and floods their distance fields
+std::shared_ptr<const Landmarks> buildLandmarks(const Grid& g, int count = kLandmarkCount);
+
+// Disk cache. load returns nullptr when the file is missing or was built
+// for a different map; both report failure instead of throwing.
+std::shared_ptr<const Landmarks> loadLandmarks(const Grid& g, const std::string& path);
+bool saveLandmarks(const Grid& g, const Landmarks& lm, const std::string& path);
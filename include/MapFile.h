@@ -0,0 +1,54 @@
+#pragma once
+#include "Grid.h"
+#include <string>
+#include <memory>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file (mmap, or a file mapping on
+// Windows). Unmapped when the last shared_ptr to it goes away.
+class MappedFile {
+public:
+    static std::shared_ptr<const MappedFile> open(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return bytes; }
+    std::size_t size() const { return length; }
+
+private:
+    MappedFile() = default;
+
+    const unsigned char* bytes{ nullptr };
+    std::size_t length{ 0 };
+#ifdef _WIN32
+    void* file{ nullptr };
+    void* mapping{ nullptr };
+#else
+    int fd{ -1 };
+#endif
+};
+
+// Binary .aimap maps, laid out to be used straight from the mapping:
+//   header     magic "AIMP", version, w, h, the four depot cells, layer count
+//   directory  one entry per layer: kind, element count, byte offset, byte size
+//   layers     8-byte aligned: tiles (1 byte per cell, required), cover
+//              (float per cell), landmarks (points, then interleaved 16-bit
+//              distances), JPS runs (down plane, then up plane) and HPA*
+//              clusters (entrance cells and their border links)
+// Landmark distances, by far the largest layer, are read in place and the
+// other planes are copied out with one memcpy each. Cluster tables are
+// re-linked from the stored entrances instead of rescanning every border.
+// Layers missing from a file are built at load as for text maps. All
+// integers are little-endian.
+bool readAimap(const std::string& path, Grid& out);
+
+// Writes g's tiles and depots, plus its derived layers when withLayers is set
+bool writeAimap(const Grid& g, const std::string& path, bool withLayers = true);
+
+// ASCII map import: one read of the whole file, then rows are converted in
+// blocks of kImportRowBlock in parallel. Fills tiles and any depots found;
+// derived layers are left to the caller. Returns false if the file is
+// missing or holds no rows.
+bool readAsciiMap(const std::string& path, Grid& out);
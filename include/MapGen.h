@@ -0,0 +1,24 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include <cstdint>
+
+// Seeded map generator for load tests, 64x64 up to 16384x16384. The same
+// parameters always give the same map.
+struct MapGenParams {
+    int w{ 256 }, h{ 256 };
+    std::uint32_t seed{ 1 };
+    float rockDensity{ 0.08f };     // fraction of cells covered by rock clusters
+    float treeDensity{ 0.04f };     // ... by tree lines
+    float waterDensity{ 0.05f };    // ... by lakes
+    int chokepoints{ 2 };           // rock walls across the map, each with a few narrow gaps
+};
+
+// Blue's base is the top-left corner, Orange's the bottom-right; both are
+// kept clear and hold their team's depots. Every passable cell is reachable
+// from both bases: pockets the flood fill from Blue's base does not reach
+// are filled with rock. Derived layers are not built (see Grid::buildDerived).
+Grid generateMap(const MapGenParams& p);
+
+// Side of the cleared square in each corner
+int baseSize(const Grid& g);
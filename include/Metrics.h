@@ -0,0 +1,115 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// How much work the engine does, where Profiler.h says how long it takes:
+// counters, gauges and histograms that are always on. Each thread adds into
+// its own slot (no locks, no shared cache lines on the hot path) and readers
+// sum the slots, from any thread, while the game runs.
+//
+//   metrics::add(Counter::LosChecks);
+//   metrics::record(Histogram::AStarNodes, pops);
+//
+// Allocations are counted by the replacement operator new in Metrics.cpp,
+// process-wide (every thread, including the renderer's).
+
+enum class Counter : int {
+    Ticks,
+    AStarCalls,
+    AStarNodes,         // nodes expanded
+    BfsCalls,
+    BfsNodes,           // nodes visited
+    JpsCalls,
+    JpsNodes,           // jump points popped
+    HpaCalls,           // abstract searches; refinement counts as A*
+    HpaNodes,           // abstract nodes popped
+    LosChecks,
+    LosCells,           // cells walked
+    RiskCells,          // risk cells written
+    LogBytes,           // written to the debug logs
+    Allocations,
+    AllocatedBytes,
+    Shots,              // game events, counted by MetricsEventSink
+    Hits,
+    Grenades,           // thrown
+    Deaths,
+    Revives,
+    Resupplies,
+    Count
+};
+
+// Last value set wins
+enum class Gauge : int {
+    BulletsAlive,
+    Count
+};
+
+enum class Histogram : int {
+    AStarNodes,         // per call
+    BfsNodes,           // per call
+    JpsNodes,           // per call
+    HpaNodes,           // per call
+    TickAllocations,    // per Game::step
+    Count
+};
+
+// Log-linear buckets as in HDR histograms: exact below 8, then 8 buckets per
+// power of two, so any value is reported within 12.5%
+struct HistogramData {
+    static constexpr int kSubBits = 3;
+    static constexpr int kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+    std::array<std::uint64_t, kBuckets> buckets{};
+    std::uint64_t count{ 0 }, sum{ 0 }, max{ 0 };
+
+    static int bucketOf(std::uint64_t v);
+    // Largest value that lands in bucket b
+    static std::uint64_t bucketHigh(int b);
+
+    double mean() const { return count ? (double)sum / count : 0.0; }
+    // Nearest rank, as the bucket's largest value (never above max)
+    std::uint64_t quantile(double q) const;
+};
+
+struct MetricsSnapshot {
+    std::array<std::uint64_t, (int)Counter::Count> counters{};
+    std::array<std::int64_t, (int)Gauge::Count> gauges{};
+    std::array<HistogramData, (int)Histogram::Count> histograms{};
+
+    std::uint64_t operator[](Counter c) const { return counters[(int)c]; }
+    std::int64_t operator[](Gauge g) const { return gauges[(int)g]; }
+    const HistogramData& operator[](Histogram h) const { return histograms[(int)h]; }
+
+    // What happened between earlier and this one; gauges and histogram
+    // maxima are this snapshot's
+    MetricsSnapshot since(const MetricsSnapshot& earlier) const;
+};
+
+namespace metrics
+{
+    void add(Counter c, std::uint64_t n = 1);
+    void set(Gauge g, std::int64_t v);
+    void record(Histogram h, std::uint64_t v);
+
+    // Allocations so far, for measuring a stretch of code
+    std::uint64_t allocations();
+
+    // Sums every thread's slot; a running game may be a few updates ahead
+    // of or behind a consistent cut
+    void read(MetricsSnapshot& out);
+
+    const char* name(Counter c);
+    const char* name(Gauge g);
+    const char* name(Histogram h);
+
+    // One JSON object on one line: ms since start, counters, gauges and
+    // count / mean / p50 / p99 / max per histogram
+    void writeJson(std::ostream& os, const MetricsSnapshot& s, double ms);
+
+    // Appends a line to path every intervalMs from a thread of its own, and
+    // a last one on stopDump
+    bool startDump(const std::string& path, int intervalMs, std::string& error);
+    void stopDump();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include "HPAStar.h"
+#include <vector>
+#include <array>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+struct PathRequest {
+    IVec2 start, goal;
+    const RiskMap* riskLayer;
+    float alpha;
+
+    bool operator==(const PathRequest& o) const {
+        return start == o.start && goal == o.goal &&
+               riskLayer == o.riskLayer && alpha == o.alpha;
+    }
+};
+
+struct PathServiceStats {
+    std::uint64_t requests{ 0 };
+    std::uint64_t solved{ 0 };
+    std::uint64_t dedupHits{ 0 };
+    std::uint64_t hierarchical{ 0 };   // solved on the HPA* abstraction
+    std::uint64_t jumpPoint{ 0 };      // solved by jump point search (flat risk)
+    std::size_t   lastQueueDepth{ 0 };
+    std::size_t   maxQueueDepth{ 0 };
+
+    // Bucket i counts solves that took [2^i, 2^(i+1)) microseconds (bucket 0 also takes < 1us)
+    std::array<std::uint64_t, 20> solveMicros{};
+
+    double dedupRate() const {
+        return requests ? double(dedupHits) / double(requests) : 0.0;
+    }
+};
+
+// Collects path queries during the AI phase, merges identical ones and
+// solves the unique set in parallel when flushed. Callbacks run on the
+// flushing thread in request order once every path is ready, so callers
+// can treat flush() as the barrier between planning and moving.
+// request() is thread safe; flush() must not race with request().
+// Queues, dedup table and result paths keep their storage between flushes,
+// so a service in steady use stops allocating; keep callbacks small enough
+// for std::function to store in place (two pointers).
+class PathService {
+public:
+    using Callback = std::function<void(const std::vector<IVec2>&)>;
+
+    // Room for flushes of up to requests queries with paths of up to
+    // pathCells cells, so reaching them mid-game does not allocate
+    void reserve(std::size_t requests, std::size_t pathCells);
+
+    void request(const PathRequest& r, Callback onDone);
+    // scratch holds per-flush bookkeeping, e.g. the caller's TickArena
+    void flush(const Grid& g, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+    std::size_t queueDepth() const { return waiting.size(); }
+    const PathServiceStats& stats() const { return st; }
+
+private:
+    struct KeyHash {
+        std::size_t operator()(const PathRequest& r) const;
+    };
+
+    std::mutex m;
+    std::vector<PathRequest> unique;
+    std::pmr::unsynchronized_pool_resource lookupNodes;    // guarded by m, like lookup
+    std::pmr::unordered_map<PathRequest, int, KeyHash> lookup{ &lookupNodes };
+    std::vector<std::pair<int, Callback>> waiting;
+    std::vector<std::vector<IVec2>> results;            // first unique.size() are this flush's
+    HpaCosts hpaCosts;
+    PathServiceStats st;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+// Timing zones for the tick pipeline. Built with AI_PROFILE the macros below
+// record every zone into a buffer owned by the running thread (no locks on
+// the hot path); without it they compile to nothing. After a run the buffers
+// can be written as a Chrome trace (chrome://tracing, ui.perfetto.dev) and
+// summarised per zone.
+//
+//   PROFILE_ZONE("risk");                   times the rest of the enclosing block
+//   PROFILE_BEGIN(heal, "heal"); ...        times a stretch of statements that
+//   PROFILE_END(heal);                      is not a block of its own
+//
+// Zone names must be string literals: only the pointer is kept.
+namespace profiler
+{
+    // Nanoseconds on the clock zones are stamped with
+    std::int64_t nowNs();
+    void record(const char* name, std::int64_t startNs, std::int64_t endNs);
+
+    // The rest read or reset every thread's buffer: call them only while no
+    // zone can be open, e.g. after the game has finished
+    std::size_t eventCount();
+    bool writeChromeTrace(const std::string& path, std::string& error);
+    // Per zone: calls, total, mean, p50, p99 and max
+    void printSummary(std::ostream& os);
+    void clear();
+
+    class Zone {
+    public:
+        explicit Zone(const char* zoneName) : name(zoneName), start(nowNs()) {}
+        ~Zone() { end(); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+        void end()
+        {
+            if (!name) return;
+            record(name, start, nowNs());
+            name = nullptr;
+        }
+
+    private:
+        const char* name;
+        std::int64_t start;
+    };
+}
+
+#ifdef AI_PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ::profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_BEGIN(id, name) ::profiler::Zone profileZone_##id(name)
+#define PROFILE_END(id) profileZone_##id.end()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_BEGIN(id, name) ((void)0)
+#define PROFILE_END(id) ((void)0)
+#endif
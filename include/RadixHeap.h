@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Path costs are searched as integers: a step costing c becomes
+// quantCost(c) = round(c * kCostScale). Steps cost at least 1, i.e. at
+// least kCostScale units, so heuristics in steps scale the same way.
+constexpr std::uint32_t kCostScale = 256;
+
+inline std::uint32_t quantCost(float c)
+{
+    return (std::uint32_t)(c * (float)kCostScale + 0.5f);
+}
+
+// Monotone priority queue (radix heap) for Dijkstra and A* with consistent
+// heuristics: every pushed key must be >= the last popped key. Bucket i
+// holds keys whose highest bit differing from the last popped key is bit
+// i-1, so each entry moves down at most 32 times over its life. Entries
+// with equal keys pop newest first.
+template <typename T>
+class RadixHeap {
+public:
+    void push(std::uint32_t key, const T& v) {
+        buckets[bucketOf(key)].push_back({ key, v });
+        count++;
+    }
+
+    // Precondition: !empty()
+    T pop(std::uint32_t* key = nullptr) {
+        if (buckets[0].empty()) refill();
+        auto top = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        if (key) *key = top.first;
+        return top.second;
+    }
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void clear() {
+        for (auto& b : buckets) b.clear();
+        count = 0;
+        last = 0;
+    }
+
+private:
+    int bucketOf(std::uint32_t key) const {
+        std::uint32_t diff = key ^ last;
+        if (diff == 0) return 0;
+#ifdef _MSC_VER
+        unsigned long bit;
+        _BitScanReverse(&bit, diff);
+        return (int)bit + 1;
+#else
+        return 32 - __builtin_clz(diff);
+#endif
+    }
+
+    // Move the smallest key of the first non-empty bucket to the front and
+    // redistribute that bucket; all of it lands in lower buckets
+    void refill() {
+        std::size_t i = 1;
+        while (buckets[i].empty()) ++i;
+        std::uint32_t lo = buckets[i][0].first;
+        for (auto& e : buckets[i])
+            if (e.first < lo) lo = e.first;
+        last = lo;
+        for (auto& e : buckets[i])
+            buckets[bucketOf(e.first)].push_back(e);
+        buckets[i].clear();
+    }
+
+    std::array<std::vector<std::pair<std::uint32_t, T>>, 33> buckets;
+    std::uint32_t last{ 0 };
+    std::size_t count{ 0 };
+};
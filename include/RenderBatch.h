@@ -0,0 +1,123 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include "BitmapFont.h"
+#include <vector>
+#include <cstdint>
+
+struct RenderSnapshot;
+struct MetricsSnapshot;
+
+// What the renderer draws, with no GL in sight: colours, the terrain image
+// and the per-frame list of coloured quads for agents, projectiles, labels
+// and the HUD.
+
+struct Rgba8 {
+    std::uint8_t r, g, b, a;
+};
+
+constexpr Rgba8 rgb(float r, float g, float b)
+{
+    return { (std::uint8_t)(r * 255 + 0.5f), (std::uint8_t)(g * 255 + 0.5f), (std::uint8_t)(b * 255 + 0.5f), 255 };
+}
+
+Rgba8 tileColor(Tile t);
+
+// One texel per cell for the w x h cells from (x0, y0), row by row
+void terrainPixels(const Grid& g, int x0, int y0, int w, int h, std::vector<Rgba8>& out);
+
+// Axis-aligned quads, four vertices each, laid out for glVertexPointer/
+// glTexCoordPointer/glColorPointer. All of them sample the font atlas:
+// plain coloured quads its solid cell, text the glyphs (ink keeps the
+// vertex colour, the rest is transparent).
+struct QuadBatch {
+    struct Vertex {
+        float x, y;
+        float u, v;
+        Rgba8 c;
+    };
+    std::vector<Vertex> verts;
+
+    void clear() { verts.clear(); }
+    std::size_t quads() const { return verts.size() / 4; }
+
+    void quad(float x, float y, float w, float h, Rgba8 c)
+    {
+        const float u = FontAtlas::kSolidU, v = FontAtlas::kSolidV;
+        verts.push_back({ x, y, u, v, c });
+        verts.push_back({ x + w, y, u, v, c });
+        verts.push_back({ x + w, y + h, u, v, c });
+        verts.push_back({ x, y + h, u, v, c });
+    }
+
+    // s drawn from (x, y) as its top-left corner, scale units per font pixel
+    void text(float x, float y, float scale, const char* s, Rgba8 c);
+};
+
+// The part of the world on screen. Quads entirely outside it are culled.
+// When a pixel covers more than a cell (pixel > 1), quads grow to one pixel
+// so nothing vanishes, and only the first quad per pixel is kept, so a
+// frame never holds more quads than the screen has pixels.
+struct ViewRect {
+    float x0{ -1e30f }, y0{ -1e30f }, x1{ 1e30f }, y1{ 1e30f };
+    float pixel{ 0 };   // world units per screen pixel; 0 = no level of detail
+
+    bool overlaps(float x, float y, float w, float h) const
+    {
+        return x + w >= x0 && x <= x1 && y + h >= y0 && y <= y1;
+    }
+};
+
+// Screen pixels that already hold a quad while batchDynamic snaps to whole
+// pixels: one bit per pixel of the view. Keeps its storage between frames
+// and clears only the words the last frame set.
+class PixelMask {
+public:
+    void begin(const ViewRect& view);
+    // False if the pixel is taken already; pixels outside the view are
+    // never tracked
+    bool claim(std::int64_t px, std::int64_t py);
+
+private:
+    std::int64_t ox{ 0 }, oy{ 0 }, w{ 0 }, h{ 0 };
+    std::vector<std::uint64_t> bits;
+    std::vector<std::size_t> touched;
+};
+
+struct AgentLabel {
+    float x, y;         // top-left corner of the agent's cell
+    char glyph;
+    int hp;
+};
+
+// Living agents, bullets, trails and grenades of both teams in view, in draw
+// order. Agents are placed alpha of the way from their position in prev to
+// the one in cur (units are matched by index; without a matching prev they
+// sit at cur); projectiles come from cur alone. The agents drawn are listed
+// in labelled (if given) for their labels. taken is the caller's scratch
+// for the pixels already drawn when the view is zoomed out.
+void batchDynamic(const RenderSnapshot& prev, const RenderSnapshot& cur, float alpha, QuadBatch& batch,
+                  PixelMask& taken, const ViewRect& view = {}, std::vector<AgentLabel>* labelled = nullptr);
+
+// World units per font pixel for agent labels in view: whole screen pixels,
+// growing with the cells; 0 while cells are narrower than kLabelMinPixels
+float labelScale(const ViewRect& view);
+
+// Each agent's glyph centred in its cell and its HP just below, in black,
+// scale world units per font pixel
+void batchLabels(QuadBatch& batch, const std::vector<AgentLabel>& labels, float scale);
+
+// Frame numbers the HUD shows beside what the snapshot knows
+struct HudStats {
+    float fps{ 0 };
+    double speed{ 1 };      // 0 = paused
+    bool unlimited{ false };
+    // Engine counters over a recent stretch of ticks, shown under the team
+    // lines when set
+    const MetricsSnapshot* metrics{ nullptr };
+};
+
+// Tick, tick time, FPS, speed and a summary line per team in the top-left
+// corner, the metrics overlay, plus the game-over banner; in pixels of a
+// width x height screen
+void batchHud(QuadBatch& batch, const RenderSnapshot& snap, const HudStats& stats, int width, int height);
@@ -1,4 +1,8 @@
 #pragma once
 #include "Game.h"
-void runGraphics(Game& game); 
-void runConsole(Game& game);
+// The simulation runs on its own thread at ticksPerSecond (0 = as fast as
+// possible); the window can pause and fast-forward it
+void runGraphics(Game& game, double ticksPerSecond = kTickRate);
+// ANSI terminal view (USE_CONSOLE builds): the same simulation thread,
+// drawn as coloured glyphs
+void runConsole(Game& game, double ticksPerSecond = kTickRate);
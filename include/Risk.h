@@ -1,6 +1,24 @@
 #pragma once
 #include "Types.h"
 #include "Grid.h"
+#include "Chunks.h"
 #include <vector>
-std::vector<float> makeRisk(const Grid& g, const std::vector<IVec2>& enemyHints, float base=0.1f);
-inline float riskAt(const std::vector<float>& r, const Grid& g, IVec2 p){ return r[p.y*g.w+p.x]; }
+
+// Risk layer of one team. Chunks no enemy can reach are never allocated;
+// read cells through riskAt, which gives them base risk under cover just
+// like the awake chunks. See makeRisk.
+using RiskMap = ChunkedLayer<float>;
+
+// Per-cell risk multiplier from cover: trees/rock underfoot and LOS-blocking
+// neighbours. Static, so Grid builds it once at load (Grid::cover) on maps
+// up to kCoverMaxCells; coverAt falls back to computing single cells.
+std::vector<float> buildCoverMap(const Grid& g);
+float coverAt(const Grid& g, IVec2 p);
+RiskMap makeRisk(const Grid& g, const std::vector<IVec2>& enemyHints, float base=0.1f);
+// Rebuilds out in place, reusing the chunks it already has
+void makeRisk(const Grid& g, const std::vector<IVec2>& enemyHints, float base, RiskMap& out);
+inline float riskAt(const RiskMap& r, const Grid& g, IVec2 p)
+{
+    const float* c = r.chunk(r.chunkOf(p.x, p.y));
+    return c ? c[RiskMap::local(p.x, p.y)] : r.fillValue() * coverAt(g, p);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include "Risk.h"
+#include <vector>
+#include <optional>
+#include <cstddef>
+
+// Nearest "safe" cell (risk at or below a threshold) for a set of units,
+// solved once per distinct cell they stand on by a bfsFindSafe flood, which
+// stops at the closest safe cell. A multi-source BFS seeded at the safe
+// cells has to search every unit's neighbourhood out to its answer's
+// distance and measured 2-5x slower than these floods (--bench safe).
+// Buffers are reused, so rebuilding every tick does not allocate.
+class SafeField {
+public:
+    // Sizes the buffers for up to `units` units
+    void reserve(int units);
+
+    // Solves units[0..count) with bfsFindSafe(g, unit, risk, maxRisk, radius)
+    void update(const Grid& g, const RiskMap& risk, float maxRisk, const IVec2* units, std::size_t count, int radius);
+
+    // The answer for a unit of the last update: the closest safe cell no
+    // more than radius + 1 steps away, or nothing
+    std::optional<IVec2> nearest(IVec2 unit) const;
+
+private:
+    struct Answer {
+        IVec2 unit;
+        std::optional<IVec2> safe;
+    };
+    std::vector<Answer> answers;     // sorted by unit cell, one per cell
+};
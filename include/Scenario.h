@@ -0,0 +1,65 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <utility>
+
+enum class Role : std::uint8_t {
+    Commander = 0, Warrior, Medic, Porter
+};
+
+struct UnitStats {
+    int hp{ 100 };
+    int ammo{ 0 };
+    int grenades{ 0 };
+};
+
+// Starting stats of a role when the scenario does not say otherwise:
+// warriors carry 20 bullets and 2 grenades, everyone else is unarmed
+UnitStats defaultStats(Role r);
+
+struct ScenarioUnit {
+    Team team;
+    Role role;
+    IVec2 pos;
+    UnitStats stats;
+};
+
+// Who starts where on which map, with what, under which rules. Text format,
+// one declaration per line, '#' starts a comment:
+//   name <text>                      shown at startup
+//   map <path>                       relative to the scenario file
+//   stats <blue|orange> <role> [hp=N] [ammo=N] [grenades=N]
+//                                    defaults for that team's units of the role
+//   unit <blue|orange> <role> <x> <y> [hp=N] [ammo=N] [grenades=N]
+//   tune <name> <value>              overrides a gameplay number (Tunables.h)
+// Each team has exactly one commander, medic and porter and any number
+// (at least one) of warriors. Declaration order does not matter.
+struct Scenario {
+    std::string name;
+    std::string map;
+    std::vector<ScenarioUnit> units;
+    std::vector<std::pair<std::string, std::string>> tunes;  // in file order
+
+    // First unit of that team and role; (0, 0) if there is none
+    IVec2 spawn(Team t, Role r) const;
+};
+
+// On failure error holds "file:line: message" and false is returned. Tune
+// names and values are checked here but only take effect through
+// applyScenarioTunables.
+bool loadScenario(const std::string& path, Scenario& out, std::string& error);
+bool saveScenario(const Scenario& s, const std::string& path);
+
+// Checks the unit counts above and that every unit stands on its own
+// passable cell of g
+bool validateScenario(const Scenario& s, const Grid& g, std::string& error);
+
+// Units spread outwards from each base corner over open cells: one
+// commander, medic and porter plus warriorsPerTeam warriors per team
+Scenario cornerScenario(const Grid& g, int baseSize, int warriorsPerTeam);
+
+// Passes the scenario's tune lines to applyTunables, in order
+bool applyScenarioTunables(const Scenario& s, std::string& error);
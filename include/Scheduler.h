@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <cstdint>
+
+// Things that can make an idle piece of team AI worth re-evaluating
+enum class AgentEvent : std::uint8_t {
+    DamageTaken = 0,
+    AmmoDepleted,
+    EnemySighted,
+    CooldownExpired,
+    Revived
+};
+
+inline std::uint32_t eventBit(AgentEvent e) { return 1u << (unsigned)e; }
+
+// Event and timer scheduler for one team.
+// AI sections subscribe as "watchers" to a set of events and are only run
+// while awake; posting a matching event (or a wake-up timer reaching its
+// tick) wakes them again. A sleeping watcher costs nothing per tick.
+class AgentScheduler {
+public:
+    // Returns a watcher id. New watchers start awake so the first tick scans.
+    int subscribe(std::uint32_t eventMask);
+
+    void post(AgentEvent e);
+    void wakeAt(int tick, AgentEvent e);   // post e once 'tick' is reached
+    void advance(int tick);                // fire every timer due at or before tick
+
+    bool awake(int watcher) const { return watchers[watcher].awake; }
+    void sleep(int watcher) { watchers[watcher].awake = false; }
+    void wake(int watcher) { watchers[watcher].awake = true; }
+
+    std::size_t pendingTimers() const { return timers.size(); }
+
+private:
+    struct Watcher {
+        std::uint32_t mask;
+        bool awake;
+    };
+
+    struct Wakeup {
+        int tick;
+        AgentEvent ev;
+    };
+
+    struct Later {
+        bool operator()(const Wakeup& a, const Wakeup& b) const {
+            return a.tick > b.tick;
+        }
+    };
+
+    std::vector<Watcher> watchers;
+    std::priority_queue<Wakeup, std::vector<Wakeup>, Later> timers;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+// Per-cell state of one grid search (A*, JPS), reused by every search on
+// the calling thread. Cells live in kSearchBlock x kSearchBlock blocks that
+// are taken from a pool and reset the first time a search reaches them
+// (a generation stamp marks the blocks of the current search). A search
+// therefore pays for the area it explores rather than its whole rectangle,
+// and the pool only grows to the most blocks one search has reached.
+class SearchScratch {
+public:
+    static constexpr std::uint32_t kUnreached = std::numeric_limits<std::uint32_t>::max();
+
+    struct Node {
+        std::uint32_t g;    // cost so far, kUnreached until reached
+        int parent;         // rectangle index of the previous cell, -1 for none
+        bool closed;
+    };
+
+    static SearchScratch& forThread() {
+        thread_local SearchScratch s;
+        return s;
+    }
+
+    // Starts a search over a rectangle of rw x rh cells; at() then takes
+    // coordinates relative to its corner
+    void begin(int rw, int rh) {
+        bw = (rw + kSearchBlock - 1) >> kSearchBlockShift;
+        std::size_t blocks = (std::size_t)bw * ((rh + kSearchBlock - 1) >> kSearchBlockShift);
+        if (slot.size() < blocks) {
+            slot.resize(blocks);
+            stamp.resize(blocks, 0);
+        }
+        if (++generation == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        used = 0;
+    }
+
+    Node& at(int x, int y) {
+        int b = (y >> kSearchBlockShift) * bw + (x >> kSearchBlockShift);
+        if (stamp[b] != generation) take(b);
+        return slot[b][((y & (kSearchBlock - 1)) << kSearchBlockShift) | (x & (kSearchBlock - 1))];
+    }
+
+    // Blocks held by the pool, i.e. the most one search has reached
+    std::size_t blocksHeld() const { return pool.size(); }
+
+    static constexpr int kBlockCells = kSearchBlock * kSearchBlock;
+
+private:
+    void take(int b) {
+        if (used == pool.size()) pool.emplace_back(new Node[kBlockCells]);
+        Node* n = pool[used++].get();
+        std::fill(n, n + kBlockCells, Node{ kUnreached, -1, false });
+        slot[b] = n;
+        stamp[b] = generation;
+    }
+
+    int bw{ 0 };
+    std::vector<Node*> slot;        // per block of the rectangle
+    std::vector<unsigned> stamp;    // generation that slot belongs to
+    unsigned generation{ 0 };
+    std::vector<std::unique_ptr<Node[]>> pool;
+    std::size_t used{ 0 };          // pool blocks handed out this search
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include "Snapshot.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+struct Game;
+
+// Runs Game::step on its own thread at a fixed tick rate times a speed
+// factor (or as fast as possible) and publishes a RenderSnapshot after every
+// tick. Nothing else may touch the game between start() and stop().
+class SimThread {
+public:
+    // ticksPerSecond <= 0 starts out unlimited
+    SimThread(Game& game, double ticksPerSecond);
+    ~SimThread();
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    void start();
+    void stop();
+
+    // Multiple of the base tick rate, clamped to [0, kMaxSpeedup]; 0 pauses
+    void setSpeed(double factor);
+    double speed() const { return speedFactor.load(); }
+
+    // Ignore the tick rate and step back to back
+    void setUnlimited(bool on) { unlimitedFlag = on; }
+    bool unlimited() const { return unlimitedFlag; }
+
+    // The game is over and its last snapshot has been published
+    bool finished() const { return done; }
+
+    // Seconds since start() on the clock snapshots are stamped with
+    double now() const;
+
+    // Reader side belongs to the renderer
+    TripleBuffer<RenderSnapshot> snapshots;
+
+private:
+    void run();
+    void publish(float tickMs);
+
+    Game& game;
+    double baseRate;
+    std::atomic<double> speedFactor{ 1.0 };
+    std::atomic<bool> unlimitedFlag{ false };
+    std::atomic<bool> stopping{ false };
+    std::atomic<bool> done{ false };
+    std::chrono::steady_clock::time_point epoch;
+    std::thread thread;
+};
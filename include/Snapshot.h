@@ -0,0 +1,40 @@
+#pragma once
+#include "Types.h"
+#include "Scenario.h"
+#include <vector>
+
+struct Game;
+
+// Immutable copy of what the renderer shows of one tick, so it can draw
+// while the simulation thread is already computing the next ones.
+struct SnapAgent {
+    float x, y;
+    int hp;
+    char glyph;
+    Team team;
+    Role role;
+    bool alive;
+    bool incapacitated;
+};
+
+struct SnapPoint {
+    float x, y;
+};
+
+struct RenderSnapshot {
+    int tick{ -1 };
+    bool running{ true };
+    double time{ 0 };                   // seconds on the simulation clock when taken
+    float tickMs{ 0 };                  // how long Game::step took for this tick
+    // Every agent of both teams in a fixed order (commander, warriors,
+    // medic, porter; Blue then Orange), so index i is the same unit in
+    // every snapshot of a game
+    std::vector<SnapAgent> agents;
+    std::vector<SnapPoint> bullets;     // live bullets
+    std::vector<SnapPoint> trails;
+    std::vector<SnapPoint> grenades;
+};
+
+// Refills out from game. The vectors keep their capacity, so steady-state
+// captures do not allocate.
+void captureSnapshot(const Game& game, double time, RenderSnapshot& out);
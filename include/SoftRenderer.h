@@ -0,0 +1,64 @@
+#pragma once
+#include "RenderBatch.h"
+#include "Camera.h"
+#include <vector>
+#include <cstdint>
+
+// RGB image, three bytes per pixel, rows top to bottom
+struct Framebuffer {
+    int w{ 0 }, h{ 0 };
+    std::vector<std::uint8_t> rgb;
+
+    void resize(int width, int height)
+    {
+        w = width;
+        h = height;
+        rgb.resize((std::size_t)width * height * 3);
+    }
+};
+
+// Pixels [x0, x1) x [y0, y1)
+struct PixelRect {
+    int x0, y0, x1, y1;
+};
+
+// CPU twin of the OpenGL view for machines without a GPU or a display: the
+// same terrain, agents, projectiles, labels and HUD, drawn through the same
+// QuadBatch builders and point-sampled into a Framebuffer.
+//
+// The view is fixed at construction, so the terrain is drawn once into a
+// background image that every frame starts from. render() only reads the
+// renderer, so several threads can draw frames at once, each with its own
+// Scratch and Framebuffer.
+class SoftRenderer {
+public:
+    // Per-thread working memory; keeps its capacity between frames
+    struct Scratch {
+        QuadBatch batch;
+        std::vector<AgentLabel> labels;
+        PixelMask taken;                // pixels drawn this frame when zoomed out
+        std::vector<PixelRect> dirty;   // where the last frame differs from backgroundImage()
+    };
+
+    SoftRenderer(const Grid& g, int width, int height, const Camera& cam = {});
+
+    int width() const { return background.w; }
+    int height() const { return background.h; }
+    // What every frame starts from, so encoders can reuse its conversion
+    const Framebuffer& backgroundImage() const { return background; }
+
+    // Agents alpha of the way from prev to cur, as batchDynamic places them
+    void render(const RenderSnapshot& prev, const RenderSnapshot& cur, float alpha, const HudStats& hud,
+                Framebuffer& fb, Scratch& scratch) const;
+
+private:
+    // Quads from world (or, for the HUD, screen) units: pixel = (p - origin) * scale
+    void drawQuads(const QuadBatch& batch, float ox, float oy, float sx, float sy, Framebuffer& fb,
+                   std::vector<PixelRect>& dirty) const;
+
+    Camera cam;
+    ViewRect view;
+    float sx, sy;               // screen pixels per world unit
+    Framebuffer background;     // terrain and clear colour
+    FontAtlas atlas;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "FunctionRef.h"
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Small fixed-size worker pool shared by the simulation.
+// parallelFor blocks until every index has run. The waiting thread keeps
+// executing queued tasks, so nested parallelFor calls cannot deadlock and a
+// pool without workers simply runs everything inline. With nothing left to
+// run it sleeps until its batch finishes or more work is queued. Tasks only refer to
+// the caller's function, and the queue keeps its capacity, so once warm a
+// parallelFor allocates nothing.
+class TaskPool {
+public:
+    explicit TaskPool(unsigned workers);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void parallelFor(int count, FunctionRef<void(int)> fn);
+
+    unsigned workerCount() const { return (unsigned)threads.size(); }
+
+    // One worker per extra hardware thread (the caller is the last one)
+    static TaskPool& shared();
+
+private:
+    bool tryRunOne();
+    void workerLoop();
+
+    struct Task {
+        FunctionRef<void(int)> fn;
+        std::atomic<int>* remaining;
+        int index;
+    };
+    void run(const Task& t);
+    Task popLocked();   // with m held and the queue not drained
+
+    std::vector<std::thread> threads;
+    std::vector<Task> queue;        // FIFO from head; rewound once drained
+    std::size_t head{ 0 };
+    std::mutex m;
+    std::condition_variable cv;         // workers: tasks queued or stopping
+    std::condition_variable progress;   // parallelFor callers: a batch finished or tasks queued
+    bool stopping{ false };
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "Types.h"
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Monotonic memory for data that lives no longer than one tick: allocation
+// bumps a pointer, deallocation does nothing and reset() drops everything
+// at once. The blocks are kept for the next tick; a tick that outgrew them
+// has them merged into one block big enough for it, so after the first
+// busy ticks the arena stops touching the global heap.
+//
+// Hand it to std::pmr containers. Not thread safe: one arena per thread of
+// work (each team's AI owns one, reset by Game::step once the tick is over).
+class TickArena : public std::pmr::memory_resource {
+public:
+    explicit TickArena(std::size_t firstBlock = kTickArenaBytes) : firstBlock(firstBlock) {}
+    ~TickArena() override;
+
+    TickArena(const TickArena&) = delete;
+    TickArena& operator=(const TickArena&) = delete;
+
+    // Everything allocated from the arena is dead after this
+    void reset();
+
+    std::size_t used() const { return usedBytes; }
+    std::size_t capacity() const;
+
+private:
+    struct Block {
+        std::byte* data;
+        std::size_t size;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t align) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+
+    void addBlock(std::size_t size);
+
+    std::size_t firstBlock;
+    std::vector<Block> blocks;
+    std::size_t current{ 0 };       // block being bumped
+    std::size_t offset{ 0 };        // into blocks[current]
+    std::size_t usedBytes{ 0 };     // since the last reset, padding included
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+
+// Lock-free single-producer single-consumer hand-off of the latest value.
+// The writer fills back() and publishes it; the reader takes the newest
+// published value with acquire() and reads front() until the next acquire.
+// Neither side ever waits: values published in between are simply skipped.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& back() { return slots[backIndex]; }
+
+    void publish()
+    {
+        backIndex = middle.exchange(backIndex | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader side
+    bool fresh() const { return (middle.load(std::memory_order_acquire) & kFresh) != 0; }
+
+    // Swaps in the newest published value; false (front() unchanged) if there
+    // is nothing new
+    bool acquire()
+    {
+        if (!fresh()) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr int kIndexMask = 3;
+    static constexpr int kFresh = 4;
+
+    T slots[3];
+    int backIndex{ 0 };                 // owned by the writer
+    int frontIndex{ 1 };                // owned by the reader
+    std::atomic<int> middle{ 2 };       // slot index, plus kFresh once published
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+
+// Gameplay numbers. Scenario files ("tune <name> <value>") and --tune on the
+// command line override them at startup, so balance sweeps need no rebuild.
+// Building with AI_FIXED_TUNABLES freezes them at these defaults as constexpr
+// so the simulation compiles against constants again.
+struct Tunables {
+    int gunRange{ 6 };                  // Manhattan reach of a shot
+    int gunDamage{ 20 };                // 5 shots kill
+    int grenadeRange{ 10 };             // longer than guns, for suppression
+    int grenadeDamage{ 15 };            // less than bullets
+    int advanceRange{ 4 };              // warriors close in while the nearest enemy is farther
+    int medCallHP{ 60 };                // call the medic below this
+    int reviveHP{ 100 };                // HP a medic heals or revives to
+    int maxWarriorRevives{ 1 };         // then a warrior stays dead
+    int lowAmmo{ 5 };                   // ask the porter below this
+    int resupplyAmmo{ 20 };             // a porter visit refills to this
+    int resupplyGrenades{ 2 };
+    int porterCooldown{ 50 };           // ticks between resupplies of one warrior
+    int forceCommanderFocusTick{ 600 }; // from then on warriors hunt the commander
+    // Level of detail. Warriors with no enemy within lodDistance (never less
+    // than grenadeRange) re-plan only every lodInterval ticks and follow
+    // their last route in between; an enemy coming that close promotes them
+    // back to every tick. 0 plans every warrior every tick.
+    int lodDistance{ 20 };
+    int lodInterval{ 4 };
+    // 1 skips the LOS and combat scans whose outcome the distances already
+    // decide; 0 runs them anyway (--bench lod checks both play the same)
+    int lodSkipScans{ 1 };
+};
+
+#ifdef AI_FIXED_TUNABLES
+inline constexpr Tunables kFixedTunables{};
+constexpr const Tunables& tunables() { return kFixedTunables; }
+#else
+extern Tunables g_tunables;
+inline const Tunables& tunables() { return g_tunables; }
+#endif
+
+// Sets one field of t by name; false with error for an unknown name or a
+// value that is not a whole number
+bool setTunable(Tunables& t, const std::string& name, const std::string& value, std::string& error);
+
+// Applies name/value overrides to the running game's tunables. A fixed build
+// only accepts values equal to its compiled-in defaults.
+bool applyTunables(const std::string& name, const std::string& value, std::string& error);
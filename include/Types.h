@@ -4,6 +4,7 @@
 #include <optional>
 #include <cstdint>
 #include <cmath>
+#include "Tunables.h"
 
 struct IVec2 {
     int x{ 0 }, y{ 0 };
@@ -40,57 +41,78 @@ inline const char* teamName(Team t)
 
 // CONSTANTS
 constexpr int  kSightRange = 10;
-constexpr int  kGunRange = 6;
-constexpr int  kGrenadeRange = 4;
-constexpr int  kGrenadeDamage = 15;       // Reduced from 45-60 to 15
-constexpr int  kMaxHP = 100;
 constexpr int  kLowHPThreshold = 25;      // 25% of max HP
-constexpr int  kMedCallHP = 60;           // Call medic if HP below this
-constexpr int  kLowAmmo = 5;              // Low ammo threshold
 constexpr int  kSafeSearchRadius = 8;
 constexpr float kMaxSafeRisk = 0.25f;
-constexpr int  kPorterCooldown = 50;  // Ticks between resupplies
-// NEW: Force aggression after this tick regardless of remaining enemy warriors
-constexpr int  kForceCommanderFocusTick = 600;
-// NEW: Limit number of revives per warrior to avoid infinite loops
-constexpr int  kMaxWarriorRevives = 1;
 // NEW: Limit number of resupplies per warrior to avoid infinite sustain
 constexpr int  kMaxResuppliesPerWarrior = 6;
-
-// Game configuration
-struct GameConfig {
-    std::string name;
-    
-    // Team advantages
-    int blueExtraHP = 0;        // Extra HP for Blue warriors
-    int orangeExtraHP = 0;      // Extra HP for Orange warriors
-    int blueExtraAmmo = 0;      // Extra ammo for Blue warriors
-    int orangeExtraAmmo = 0;    // Extra ammo for Orange warriors
-    int blueExtraGrenades = 0;  // Extra grenades for Blue warriors
-    int orangeExtraGrenades = 0; // Extra grenades for Orange warriors
-    
-    // Named configurations
-    static GameConfig Balanced() {
-        GameConfig cfg;
-        cfg.name = "Balanced (Equal teams)";
-        return cfg;
-    }
-    
-    static GameConfig BlueAdvantage() {
-        GameConfig cfg;
-        cfg.name = "Blue Advantage (+20 HP, +5 ammo)";
-        cfg.blueExtraHP = 20;
-        cfg.blueExtraAmmo = 5;
-        cfg.blueExtraGrenades = 1;
-        return cfg;
-    }
-    
-    static GameConfig OrangeAdvantage() {
-        GameConfig cfg;
-        cfg.name = "Orange Advantage (+20 HP, +5 ammo)";
-        cfg.orangeExtraHP = 20;
-        cfg.orangeExtraAmmo = 5;
-        cfg.orangeExtraGrenades = 1;
-        return cfg;
-    }
-};
+// Ranges, damage, thresholds and the like are runtime tunables (Tunables.h)
+// Squads at least this large plan their warriors in parallel
+constexpr int  kParallelWarriorBatch = 16;
+// Hierarchical pathfinding: maps with at least kHpaMinMapCells cells get an
+// HPA* abstraction at load; queries longer than kHpaMinDistance use it.
+constexpr int  kHpaClusterSize = 16;
+constexpr int  kHpaMinMapCells = 256 * 256;
+constexpr int  kHpaMinDistance = 64;
+// ALT heuristic: kLandmarkCount landmark distance fields per map (2 bytes
+// per cell each), built for maps up to kLandmarkMaxCells and cached in
+// "<map>.landmarks" next to the map file when kLandmarkDiskCache is set.
+constexpr int  kLandmarkCount = 8;
+constexpr int  kLandmarkMaxCells = 2048 * 2048;
+constexpr bool kLandmarkDiskCache = true;
+// Jump point search replaces A* when a query's risk is flat over the box
+// around start and goal widened by kJpsMargin (or alpha is 0) and its path
+// is cheaper than any route that leaves the box could be. Its run
+// tables (4 bytes per cell) are built for maps up to kJpsMaxCells.
+constexpr bool kUseJps = true;
+constexpr int  kJpsMargin = 8;
+constexpr int  kJpsMaxCells = 2048 * 2048;
+// Text maps are converted in parallel, kImportRowBlock rows per task
+constexpr int  kImportRowBlock = 256;
+// Per-cell layers that follow the action (risk) are stored in chunks of
+// kChunkSize x kChunkSize cells, allocated only where enemies are in reach.
+// The static cover map is only precomputed for maps up to kCoverMaxCells.
+constexpr int  kChunkShift = 5;
+constexpr int  kChunkSize = 1 << kChunkShift;
+constexpr int  kCoverMaxCells = 4096 * 4096;
+// Grid searches keep their per-cell state in kSearchBlock x kSearchBlock
+// blocks, reset when a search first reaches them (SearchScratch)
+constexpr int  kSearchBlockShift = 4;
+constexpr int  kSearchBlock = 1 << kSearchBlockShift;
+// The renderer uploads the static terrain once, as textures of at most
+// kTerrainPage x kTerrainPage cells, one texel per cell
+constexpr int  kTerrainPage = 2048;
+// The simulation thread steps kTickRate times a second at 1x; fast-forward
+// goes up to kMaxSpeedup times that
+constexpr double kTickRate = 30.0;
+constexpr int  kMaxSpeedup = 100;
+// Agent labels are only drawn while a cell is at least kLabelMinPixels wide
+constexpr int  kLabelMinPixels = 8;
+// Each thread keeps at most kProfileMaxEvents profiler zones (AI_PROFILE
+// builds); later ones are counted and dropped
+constexpr int  kProfileMaxEvents = 1 << 22;
+// The terminal view redraws at most kConsoleFps times a second, less when
+// the terminal cannot keep up
+constexpr int  kConsoleFps = 30;
+// Positions a bullet remembers for its trail
+constexpr int  kBulletTrailLength = 10;
+// First block of a TickArena; it grows to what the busiest tick needed
+constexpr int  kTickArenaBytes = 16 * 1024;
+// Path cells each unit's result slot in the path service reserves up front
+// (at most the map's area), so a long path does not allocate mid-game
+constexpr int  kPathReserveCells = 4096;
+// Risk chunks each team's layers keep ready from the start (at most the
+// map's), so the fight waking a new part of a small map does not allocate
+constexpr int  kRiskReserveChunks = 16;
+// Game events kept in the event bus ring (a power of two)
+constexpr int  kEventRing = 1024;
+// The --metrics file gets a line, and the HUD's metrics overlay fresh
+// numbers, every kMetricsIntervalMs
+constexpr int  kMetricsIntervalMs = 1000;
+// Headless video export: frame size unless --video-size says otherwise, at
+// most kVideoBatch frames rendered at once, and how long the final frame is
+// held at the end
+constexpr int  kVideoWidth = 1280;
+constexpr int  kVideoHeight = 720;
+constexpr int  kVideoBatch = 32;
+constexpr int  kVideoHoldSeconds = 2;
@@ -0,0 +1,64 @@
+#pragma once
+#include "SoftRenderer.h"
+#include "Snapshot.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct Game;
+
+// Records one snapshot per frame and turns them into a video file with the
+// SoftRenderer: a .y4m path gets YUV4MPEG2 (4:2:0, readable by ffmpeg, mpv
+// and VLC), anything else a stream of binary PPM images. Snapshots are
+// collected in batches; each batch is drawn and encoded in parallel on the
+// shared TaskPool and written out in order.
+class VideoExport {
+public:
+    VideoExport(const Grid& g, int width, int height, int fps);
+    ~VideoExport();
+
+    VideoExport(const VideoExport&) = delete;
+    VideoExport& operator=(const VideoExport&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+
+    // Slot for the next frame's snapshot (fill it with captureSnapshot).
+    // Renders the pending batch first when it is full.
+    RenderSnapshot& record();
+
+    // Renders what is pending, repeats the last frame holdFrames more times
+    // and closes the file; false if any write failed
+    bool finish(int holdFrames = 0);
+
+    int framesWritten() const { return written; }
+    double renderSeconds() const { return renderTime; }
+
+private:
+    struct Slot {
+        RenderSnapshot snap;
+        Framebuffer fb;
+        SoftRenderer::Scratch scratch;
+        std::vector<std::uint8_t> bytes;    // the encoded Y4M frame
+    };
+
+    void flush();
+    // Converts r (widened to whole 2x2 blocks) of fb into the Y4M frame out.
+    // Y4M only; PPM frames are written straight from the framebuffer.
+    void encode(const Framebuffer& fb, const PixelRect& r, std::vector<std::uint8_t>& out) const;
+    void write(const Slot& s);
+
+    SoftRenderer renderer;
+    int fps;
+    bool y4m{ false };
+    std::FILE* file{ nullptr };
+    bool failed{ false };
+    std::vector<std::uint8_t> background;   // the renderer's background as a Y4M frame
+    std::vector<Slot> slots;
+    int pending{ 0 };
+    int written{ 0 };
+    double renderTime{ 0 };
+};
+
+// Plays the game to the end without a window, one frame per tick, into path.
+// Returns a process exit code.
+int runVideo(Game& game, const std::string& path, int width, int height);
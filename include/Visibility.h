@@ -1,6 +1,12 @@
 #pragma once
 #include "Types.h"
 #include "Grid.h"
+#include "FunctionRef.h"
 bool los(const Grid& g, IVec2 a, IVec2 b);
 bool rayLine(const Grid& g, IVec2 a, IVec2 b);
 
+// Field of view by recursive shadowcasting: calls visit once for every cell
+// within radius (Euclidean) of origin that origin can see, origin included.
+// Cover cells themselves are visible; what lies behind them is not.
+void shadowcast(const Grid& g, IVec2 origin, int radius, FunctionRef<void(IVec2)> visit);
+
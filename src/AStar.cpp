@@ -1,8 +1,12 @@
 // AStar.cpp - A* pathfinding with risk-aware cost function
-// Uses Manhattan distance heuristic and risk map for safer paths
+// Uses Manhattan distance (tightened by landmarks when the map has them)
+// as heuristic and risk map for safer paths
 
 #include "AStar.h"
-#include <queue>
+#include "Landmarks.h"
+#include "RadixHeap.h"
+#include "SearchScratch.h"
+#include "Metrics.h"
 #include <limits>
 #include <cmath> 
 #include <algorithm>
@@ -12,82 +16,111 @@ static int idx(const Grid& g, IVec2 p) {
 }
 
 std::vector<IVec2> aStarPath(const Grid& g, IVec2 start, IVec2 goal, 
-                              const std::vector<float>& risk, float alpha)
+                              const RiskMap& risk, float alpha, int* expanded)
 {
-    // Heuristic: Manhattan distance
-    auto h = [&](IVec2 a) { 
-        return std::abs(a.x - goal.x) + std::abs(a.y - goal.y); 
-    };
-    
-    struct Node { 
-        IVec2 p; 
-        float f; 
+    return aStarPathInRect(g, start, goal, risk, alpha, { 0, 0 }, { g.w - 1, g.h - 1 }, expanded);
+}
+
+void aStarPath(const Grid& g, IVec2 start, IVec2 goal,
+               const RiskMap& risk, float alpha, std::vector<IVec2>& path, int* expanded)
+{
+    aStarPathInRect(g, start, goal, risk, alpha, { 0, 0 }, { g.w - 1, g.h - 1 }, path, expanded);
+}
+
+std::vector<IVec2> aStarPathInRect(const Grid& g, IVec2 start, IVec2 goal,
+                                   const RiskMap& risk, float alpha,
+                                   IVec2 lo, IVec2 hi, int* expanded)
+{
+    std::vector<IVec2> path;
+    aStarPathInRect(g, start, goal, risk, alpha, lo, hi, path, expanded);
+    return path;
+}
+
+void aStarPathInRect(const Grid& g, IVec2 start, IVec2 goal,
+                     const RiskMap& risk, float alpha,
+                     IVec2 lo, IVec2 hi, std::vector<IVec2>& path, int* expanded)
+{
+    // Cells are numbered within the search rectangle
+    int rw = hi.x - lo.x + 1;
+    int rh = hi.y - lo.y + 1;
+    auto lidx = [&](IVec2 p) {
+        return (p.y - lo.y) * rw + (p.x - lo.x);
     };
-    
-    struct Cmp { 
-        bool operator()(const Node& a, const Node& b) const { 
-            return a.f > b.f; 
-        } 
+
+    // Heuristic: Manhattan distance, or the landmark bound where it is larger
+    // (around rocks and water). Both are admissible, so is their maximum.
+    const Landmarks* lm = g.landmarks.get();
+    const std::uint16_t* goalRow = lm ? lm->row(idx(g, goal)) : nullptr;
+    auto h = [&](IVec2 a) { 
+        int m = std::abs(a.x - goal.x) + std::abs(a.y - goal.y);
+        return lm ? std::max(m, lm->lowerBound(idx(g, a), goalRow)) : m;
     };
     
-    std::priority_queue<Node, std::vector<Node>, Cmp> open;
-    std::vector<float> gscore(g.w * g.h, std::numeric_limits<float>::infinity());
-    std::vector<int> came(g.w * g.h, -1);
+    // Integer costs on a radix heap. The heuristic is consistent, so a node
+    // is final once popped: the closed flag stops it from being expanded again.
+    // The heap and the per-cell state are reused across calls on this
+    // thread; only the blocks of cells the search reaches are reset.
+    thread_local RadixHeap<int> open;
+    open.clear();
+    SearchScratch& scratch = SearchScratch::forThread();
+    scratch.begin(rw, rh);
+    auto node = [&](IVec2 p) -> SearchScratch::Node& { return scratch.at(p.x - lo.x, p.y - lo.y); };
     
     auto inb = [&](IVec2 p) { 
-        return g.inBounds(p) && g.passable(p); 
+        return p.x >= lo.x && p.y >= lo.y && p.x <= hi.x && p.y <= hi.y && g.passable(p);
     };
     
-    gscore[idx(g, start)] = 0.f;
-    open.push({ start, (float)h(start) });
-    
-    // Get 4-directional neighbors
-    auto neigh = [&](IVec2 p) { 
-        static const int dx[4] = {1, -1, 0, 0};
-        static const int dy[4] = {0, 0, 1, -1}; 
-        std::vector<IVec2> out;
-        for (int i = 0; i < 4; ++i) { 
-            IVec2 q{p.x + dx[i], p.y + dy[i]}; 
-            if (inb(q)) out.push_back(q);
-        } 
-        return out; 
-    };
+    node(start).g = 0;
+    open.push(h(start) * kCostScale, lidx(start));
     
+    static const int dx[4] = {1, -1, 0, 0};
+    static const int dy[4] = {0, 0, 1, -1}; 
+    int gi = lidx(goal);
+    int pops = 0;
     while (!open.empty()) {
-        auto cur = open.top(); 
-        open.pop(); 
+        int ci = open.pop();
+        IVec2 cur{ lo.x + ci % rw, lo.y + ci / rw };
+        SearchScratch::Node& cn = node(cur);
+        if (cn.closed) continue;    // superseded copy
+        cn.closed = true;
+        pops++;
         
-        if (cur.p == goal) break;
+        if (ci == gi) break;
         
-        int ci = idx(g, cur.p);
-        for (auto q : neigh(cur.p)) { 
-            int qi = idx(g, q);
+        for (int i = 0; i < 4; ++i) { 
+            IVec2 q{ cur.x + dx[i], cur.y + dy[i] }; 
+            if (!inb(q)) continue;
+            SearchScratch::Node& qn = node(q);
+            if (qn.closed) continue;
             // Cost = distance + risk penalty (alpha controls risk aversion)
-            float tentative = gscore[ci] + (1.0f + alpha * risk[qi]);
+            std::uint32_t tentative = cn.g + quantCost(1.0f + alpha * riskAt(risk, g, q));
             
-            if (tentative < gscore[qi]) { 
-                gscore[qi] = tentative;
-                came[qi] = ci;
-                open.push({q, tentative + (float)h(q)}); 
+            if (tentative < qn.g) { 
+                qn.g = tentative;
+                qn.parent = ci;
+                open.push(tentative + h(q) * kCostScale, lidx(q)); 
             } 
         }
     }
     
+    if (expanded) *expanded = pops;
+    metrics::add(Counter::AStarCalls);
+    metrics::add(Counter::AStarNodes, pops);
+    metrics::record(Histogram::AStarNodes, pops);
+
     // Reconstruct path
-    std::vector<IVec2> path;
-    int gi = idx(g, goal);
+    path.clear();
     
-    if (came[gi] == -1) { 
+    if (node(goal).parent == -1) { 
         path.push_back(start);
-        return path;
+        return;
     }
     
     for (int i = gi; i != -1; ) { 
-        int y = i / g.w, x = i % g.w;
-        path.push_back({x, y});
-        i = came[i];
+        IVec2 p{ lo.x + i % rw, lo.y + i / rw };
+        path.push_back(p);
+        i = node(p).parent;
     }
     
     std::reverse(path.begin(), path.end());
-    return path;
 }
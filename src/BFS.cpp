@@ -2,15 +2,26 @@
 // Used by warriors in defense mode to find nearby safe tiles
 
 #include "BFS.h"
-#include <queue> 
+#include "Metrics.h"
 #include <cmath>
+#include <algorithm>
 
 std::optional<IVec2> bfsFindSafe(const Grid& g, IVec2 start, 
-                                  const std::vector<float>& risk, 
+                                  const RiskMap& risk, 
                                   float maxRisk, int radius)
 {
-    std::queue<IVec2> q;
-    std::vector<char> vis(g.w * g.h, 0);
+    // Scratch reused across calls on this thread: a visit stamp per cell of
+    // the search box (nothing is pushed beyond radius + 1 steps) instead of
+    // clearing an array, and a vector as the FIFO queue
+    const int reach = radius + 1, side = 2 * reach + 1;
+    thread_local std::vector<unsigned> stamp;
+    thread_local unsigned generation = 0;
+    thread_local std::vector<IVec2> q;
+    if (stamp.size() < (size_t)side * side || ++generation == 0) {
+        stamp.assign(std::max(stamp.size(), (size_t)side * side), 0);
+        generation = 1;
+    }
+    q.clear();
     
     auto inb = [&](IVec2 p) { 
         return g.inBounds(p) && g.passable(p); 
@@ -18,22 +29,28 @@ std::optional<IVec2> bfsFindSafe(const Grid& g, IVec2 start,
     
     auto push = [&](IVec2 p) { 
         if (!inb(p)) return;
-        int i = p.y * g.w + p.x;
-        if (vis[i]) return;
-        vis[i] = 1;
-        q.push(p);
+        int i = (p.y - start.y + reach) * side + (p.x - start.x + reach);
+        if (stamp[i] == generation) return;
+        stamp[i] = generation;
+        q.push_back(p);
     };
     
+    auto visited = [](size_t nodes) {
+        metrics::add(Counter::BfsCalls);
+        metrics::add(Counter::BfsNodes, nodes);
+        metrics::record(Histogram::BfsNodes, nodes);
+    };
+
     push(start);
     
-    while (!q.empty()) {
-        IVec2 p = q.front();
-        q.pop();
-        int i = p.y * g.w + p.x;
+    for (size_t head = 0; head < q.size(); ++head) {
+        IVec2 p = q[head];
         
         // Found a safe position!
-        if (risk[i] <= maxRisk) 
+        if (riskAt(risk, g, p) <= maxRisk) {
+            visited(head + 1);
             return p;
+        }
         
         // Don't search beyond radius
         if (std::abs(p.x - start.x) + std::abs(p.y - start.y) > radius)
@@ -46,5 +63,6 @@ std::optional<IVec2> bfsFindSafe(const Grid& g, IVec2 start,
         push({p.x, p.y - 1});
     }
     
+    visited(q.size());
     return std::nullopt;
 }
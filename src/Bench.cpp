@@ -0,0 +1,930 @@
+// Bench.cpp - Headless benchmarks for the pathfinding and simulation layers
+// Run as: ai_battle --bench <suite> [args]
+//   hpa [tiles] [queries]  flat A* vs HPA* on the sample map tiled tiles x tiles
+//   alt [tiles] [queries]  A* with the Manhattan heuristic vs landmark (ALT) bounds
+//   jps [tiles] [queries]  jump point search vs A* on uniform-cost maps and via the path service
+//   pq [tiles] [queries]   radix heap vs binary heap: raw queue ops and A*
+//   safe [tiles] [units]   per-unit bfsFindSafe floods vs the safe field (fails unless they agree)
+//   risk [tiles] [enemies] full-grid risk stamping vs per-enemy shadowcast risk
+//   mapio [tiles]          text map loading (serial, parallel) vs mapped .aimap
+//   chunks [tiles] [enemies] flat W*H risk layers vs chunked risk with sleeping chunks
+//   scale [max side] [warriors] [seed] generated maps 64..max: paths, risk, LOS, full ticks
+//   alloc [scenario] [warmup] [ticks] heap allocations per tick once warm (fails if any)
+//   lod [scenario...]      level of detail: far warriors' scans run and skipped (fails unless identical)
+
+#include "Bench.h"
+#include "Grid.h"
+#include "AStar.h"
+#include "HPAStar.h"
+#include "Landmarks.h"
+#include "JPS.h"
+#include "PathService.h"
+#include "RadixHeap.h"
+#include "SafeField.h"
+#include "BFS.h"
+#include "Risk.h"
+#include "Visibility.h"
+#include "MapFile.h"
+#include "MapGen.h"
+#include "Scenario.h"
+#include "Game.h"
+#include "Metrics.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    // Repeat a map tiles x tiles times to get a large but realistic layout
+    Grid tileGrid(const Grid& base, int tiles)
+    {
+        Grid g;
+        g.w = base.w * tiles;
+        g.h = base.h * tiles;
+        g.cells.resize(g.w * g.h);
+        for (int y = 0; y < g.h; ++y)
+            for (int x = 0; x < g.w; ++x)
+                g.cells[y * g.w + x] = base.cells[(y % base.h) * base.w + (x % base.w)];
+        return g;
+    }
+
+    float pathCost(const Grid& g, const std::vector<IVec2>& path, const RiskMap& risk, float alpha)
+    {
+        float c = 0.f;
+        for (size_t i = 1; i < path.size(); ++i)
+            c += 1.0f + alpha * riskAt(risk, g, path[i]);
+        return c;
+    }
+
+    // The cost A* minimises: each step quantised as in RadixHeap.h. Equal
+    // for equally good paths, where float sums can differ in the last bits.
+    std::uint64_t quantPathCost(const Grid& g, const std::vector<IVec2>& path, const RiskMap& risk, float alpha)
+    {
+        std::uint64_t c = 0;
+        for (size_t i = 1; i < path.size(); ++i)
+            c += quantCost(1.0f + alpha * riskAt(risk, g, path[i]));
+        return c;
+    }
+
+    IVec2 randomOpenCell(const Grid& g, std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> dx(0, g.w - 1), dy(0, g.h - 1);
+        while (true) {
+            IVec2 p{ dx(rng), dy(rng) };
+            if (g.passable(p)) return p;
+        }
+    }
+
+    int benchHpa(int tiles, int queries)
+    {
+        Grid base = Grid::loadFromTxt("assets/sample_map_80x50.txt");
+        Grid g = tileGrid(base, tiles);
+        std::cout << "Map " << g.w << "x" << g.h << ", cluster " << kHpaClusterSize << "\n";
+
+        auto t0 = Clock::now();
+        auto layout = buildHpaLayout(g);
+        std::cout << "Layout: " << layout->nodes.size() << " entrances, "
+                  << layout->cw * layout->ch << " clusters, built in " << msSince(t0) << " ms\n";
+
+        std::mt19937 rng(1);
+        std::vector<IVec2> enemies;
+        for (int i = 0; i < 6; ++i) enemies.push_back(randomOpenCell(g, rng));
+        auto risk = makeRisk(g, enemies, 0.05f);
+        const float alpha = 0.3f;
+
+        HpaCosts costs;
+        t0 = Clock::now();
+        costs.refresh(g, *layout, risk);
+        std::cout << "Edge costs: " << costs.lastRefreshed << " clusters in " << msSince(t0) << " ms\n";
+
+        // One enemy moves a step: only clusters near it need new edges
+        enemies[0] = enemies[0] + IVec2{ 1, 0 };
+        if (!g.inBounds(enemies[0]) || !g.passable(enemies[0])) enemies[0] = enemies[0] - IVec2{ 2, 0 };
+        auto moved = makeRisk(g, enemies, 0.05f);
+        t0 = Clock::now();
+        costs.refresh(g, *layout, moved);
+        std::cout << "Incremental refresh: " << costs.lastRefreshed << " clusters in " << msSince(t0) << " ms\n";
+        risk = moved;
+
+        double flatMs = 0, hpaMs = 0;
+        std::vector<double> ratios;
+        int failed = 0;
+        for (int q = 0; q < queries; ++q) {
+            IVec2 a, b;
+            do { a = randomOpenCell(g, rng); b = randomOpenCell(g, rng); } while (a.manhattan(b) < kHpaMinDistance);
+
+            t0 = Clock::now();
+            auto flat = aStarPath(g, a, b, risk, alpha);
+            flatMs += msSince(t0);
+
+            t0 = Clock::now();
+            auto hier = hpaPath(g, *layout, costs, a, b, risk, alpha);
+            hpaMs += msSince(t0);
+
+            if (flat.back() != b) continue;       // unreachable pair
+            if (hier.back() != b) { failed++; continue; }
+            ratios.push_back(pathCost(g, hier, risk, alpha) / pathCost(g, flat, risk, alpha));
+        }
+
+        std::sort(ratios.begin(), ratios.end());
+        double mean = 0;
+        for (double r : ratios) mean += r;
+        if (!ratios.empty()) mean /= ratios.size();
+
+        std::cout << queries << " queries: flat " << flatMs << " ms, HPA* " << hpaMs
+                  << " ms, speedup x" << (hpaMs > 0 ? flatMs / hpaMs : 0) << "\n";
+        if (!ratios.empty())
+            std::cout << "Path cost HPA*/optimal: mean " << mean
+                      << " p95 " << ratios[(ratios.size() * 95) / 100]
+                      << " max " << ratios.back() << " (failed " << failed << ")\n";
+        return failed ? 1 : 0;
+    }
+
+    // Random walk of one cell that stays on passable ground
+    IVec2 wander(const Grid& g, IVec2 p, std::mt19937& rng)
+    {
+        static const IVec2 steps[4] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+        IVec2 q = p + steps[rng() % 4];
+        return g.inBounds(q) && g.passable(q) ? q : p;
+    }
+
+    // Same size as the tiled sample map, but cut by long rock walls with a
+    // couple of gaps each: the obstacle-heavy case the landmarks are for
+    Grid walledGrid(int w, int h)
+    {
+        Grid g;
+        g.w = w;
+        g.h = h;
+        g.cells.assign(w * h, Tile::Open);
+        std::mt19937 rng(11);
+        for (int y = 5; y < h; y += 6) {
+            for (int x = 0; x < w; ++x) g.cells[y * w + x] = Tile::Rock;
+            for (int k = 0; k < 2; ++k) g.cells[y * w + rng() % w] = Tile::Open;
+        }
+        return g;
+    }
+
+    int benchAltOn(const char* name, const Grid& flat, int queries)
+    {
+        Grid alt = flat;
+        auto t0 = Clock::now();
+        alt.landmarks = buildLandmarks(alt);
+        std::cout << name << " " << alt.w << "x" << alt.h << ", " << alt.landmarks->count << " landmarks built in "
+                  << msSince(t0) << " ms (" << alt.landmarks->dist.size() * 2 / 1024 << " KiB)\n";
+
+        std::mt19937 rng(3);
+        std::vector<IVec2> enemies;
+        for (int i = 0; i < 6; ++i) enemies.push_back(randomOpenCell(flat, rng));
+        auto risk = makeRisk(flat, enemies, 0.05f);
+
+        // alpha 0 is pure walking distance, where obstacles dominate; with
+        // risk weighting every step costs more than the bound assumes
+        int mismatches = 0;
+        for (float alpha : { 0.0f, 0.3f }) {
+            long long flatNodes = 0, altNodes = 0;
+            double flatMs = 0, altMs = 0;
+            for (int q = 0; q < queries; ++q) {
+                IVec2 a = randomOpenCell(flat, rng), b = randomOpenCell(flat, rng);
+                int expanded = 0;
+
+                t0 = Clock::now();
+                auto p1 = aStarPath(flat, a, b, risk, alpha, &expanded);
+                flatMs += msSince(t0);
+                flatNodes += expanded;
+
+                t0 = Clock::now();
+                auto p2 = aStarPath(alt, a, b, risk, alpha, &expanded);
+                altMs += msSince(t0);
+                altNodes += expanded;
+
+                if (quantPathCost(flat, p1, risk, alpha) != quantPathCost(flat, p2, risk, alpha))
+                    mismatches++;
+            }
+
+            std::cout << "alpha " << alpha << ", " << queries << " queries: nodes Manhattan " << flatNodes
+                      << " vs ALT " << altNodes << " (x" << (altNodes ? double(flatNodes) / altNodes : 0)
+                      << "), time " << flatMs << " ms vs " << altMs << " ms\n";
+        }
+        std::cout << "Cost mismatches " << mismatches << "\n";
+        return mismatches ? 1 : 0;
+    }
+
+    int benchAlt(int tiles, int queries)
+    {
+        Grid base = Grid::loadFromTxt("assets/sample_map_80x50.txt");
+        Grid sample = tileGrid(base, tiles);
+        int failed = benchAltOn("Sample", sample, queries);
+        failed += benchAltOn("Walled", walledGrid(sample.w, sample.h), queries);
+        return failed ? 1 : 0;
+    }
+
+    // Open field with scattered single rocks (density in percent)
+    Grid scatterGrid(int w, int h, int density)
+    {
+        Grid g;
+        g.w = w;
+        g.h = h;
+        g.cells.assign(w * h, Tile::Open);
+        std::mt19937 rng(5);
+        for (auto& c : g.cells)
+            if ((int)(rng() % 100) < density) c = Tile::Rock;
+        return g;
+    }
+
+    int benchJpsOn(const char* name, const Grid& g, int queries)
+    {
+        Grid jg = g;
+        jg.jpsRuns = buildJpsRuns(jg);
+        std::mt19937 rng(9);
+        RiskMap flat(g.w, g.h, 0.05f);
+        long long astarNodes = 0, jpsNodes = 0;
+        double astarMs = 0, jpsMs = 0;
+        int mismatches = 0;
+        for (int q = 0; q < queries; ++q) {
+            IVec2 a = randomOpenCell(g, rng), b = randomOpenCell(g, rng);
+            int expanded = 0;
+
+            auto t0 = Clock::now();
+            auto p1 = aStarPath(g, a, b, flat, 0.f, &expanded);
+            astarMs += msSince(t0);
+            astarNodes += expanded;
+
+            t0 = Clock::now();
+            auto p2 = jpsPath(jg, a, b, { 0, 0 }, { g.w - 1, g.h - 1 }, &expanded);
+            jpsMs += msSince(t0);
+            jpsNodes += expanded;
+
+            if (p1.size() != p2.size() || p1.back() != p2.back()) mismatches++;
+        }
+        std::cout << name << " " << g.w << "x" << g.h << ": nodes A* " << astarNodes << " vs JPS " << jpsNodes
+                  << ", time " << astarMs << " ms vs " << jpsMs << " ms (x" << (jpsMs > 0 ? astarMs / jpsMs : 0)
+                  << "), length mismatches " << mismatches << "\n";
+        return mismatches;
+    }
+
+    // Risk-weighted queries through the path service, which picks JPS only
+    // inside a box around start and goal: the cost must still be A*'s
+    int benchJpsServiceOn(const char* name, const Grid& g, int queries)
+    {
+        Grid jg = g;
+        jg.jpsRuns = buildJpsRuns(jg);
+        std::mt19937 rng(9);
+        RiskMap flat(g.w, g.h, 0.05f);
+        PathService service;
+        int mismatches = 0;
+        for (int q = 0; q < queries; ++q) {
+            IVec2 a = randomOpenCell(g, rng), b = randomOpenCell(g, rng);
+            std::vector<IVec2> served;
+            service.request({ a, b, &flat, 0.3f }, [&served](const std::vector<IVec2>& p) { served = p; });
+            service.flush(jg);
+            auto best = aStarPath(g, a, b, flat, 0.3f);
+            if (served.back() != best.back() || quantPathCost(g, served, flat, 0.3f) != quantPathCost(g, best, flat, 0.3f))
+                mismatches++;
+        }
+        std::cout << name << " through the path service: " << service.stats().jumpPoint << " of " << queries
+                  << " solved by JPS, cost mismatches " << mismatches << "\n";
+        return mismatches;
+    }
+
+    int benchJps(int tiles, int queries)
+    {
+        Grid base = Grid::loadFromTxt("assets/sample_map_80x50.txt");
+        Grid sample = tileGrid(base, tiles);
+        sample.landmarks.reset();   // compare against plain Manhattan A*
+        int failed = benchJpsOn("Open field", scatterGrid(sample.w, sample.h, 0), queries);
+        failed += benchJpsOn("Sample", sample, queries);
+        failed += benchJpsOn("Scattered 20%", scatterGrid(sample.w, sample.h, 20), queries);
+        failed += benchJpsOn("Walled", walledGrid(sample.w, sample.h), queries);
+
+        // Water walls: impassable but no cover, so the risk stays flat and
+        // the best route often leaves the start/goal box
+        Grid moats = walledGrid(sample.w, sample.h);
+        std::replace(moats.cells.begin(), moats.cells.end(), Tile::Rock, Tile::Water);
+        failed += benchJpsServiceOn("Open field", scatterGrid(sample.w, sample.h, 0), queries);
+        failed += benchJpsServiceOn("Water walls", moats, queries);
+        return failed ? 1 : 0;
+    }
+
+    // The A* open list before the radix heap: float keys on a binary heap,
+    // lazy duplicates expanded again. Kept here as the baseline.
+    std::vector<IVec2> binaryHeapAStar(const Grid& g, IVec2 start, IVec2 goal,
+                                       const RiskMap& risk, float alpha, int& expanded)
+    {
+        struct Node { IVec2 p; float f; };
+        struct Cmp { bool operator()(const Node& a, const Node& b) const { return a.f > b.f; } };
+        std::priority_queue<Node, std::vector<Node>, Cmp> open;
+        std::vector<float> gscore(g.w * g.h, std::numeric_limits<float>::infinity());
+        std::vector<int> came(g.w * g.h, -1);
+        auto idx = [&](IVec2 p) { return p.y * g.w + p.x; };
+
+        gscore[idx(start)] = 0.f;
+        open.push({ start, (float)start.manhattan(goal) });
+        static const int dx[4] = { 1, -1, 0, 0 };
+        static const int dy[4] = { 0, 0, 1, -1 };
+        expanded = 0;
+        while (!open.empty()) {
+            Node cur = open.top();
+            open.pop();
+            expanded++;
+            if (cur.p == goal) break;
+            for (int i = 0; i < 4; ++i) {
+                IVec2 q{ cur.p.x + dx[i], cur.p.y + dy[i] };
+                if (!g.inBounds(q) || !g.passable(q)) continue;
+                float t = gscore[idx(cur.p)] + 1.0f + alpha * riskAt(risk, g, q);
+                if (t < gscore[idx(q)]) {
+                    gscore[idx(q)] = t;
+                    came[idx(q)] = idx(cur.p);
+                    open.push({ q, t + (float)q.manhattan(goal) });
+                }
+            }
+        }
+        std::vector<IVec2> path;
+        if (came[idx(goal)] == -1) return { start };
+        for (int i = idx(goal); i != -1; i = came[i]) path.push_back({ i % g.w, i / g.w });
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // Dijkstra-shaped workload: each pop pushes a few keys slightly above it
+    void benchQueueOps(int ops)
+    {
+        std::mt19937 rng(13);
+        std::vector<std::uint32_t> steps(ops * 3);
+        for (auto& v : steps) v = kCostScale + rng() % (kCostScale * 2);
+
+        auto t0 = Clock::now();
+        std::priority_queue<std::uint32_t, std::vector<std::uint32_t>, std::greater<std::uint32_t>> bin;
+        bin.push(0);
+        std::uint64_t sumBin = 0;
+        for (int i = 0, k = 0; i < ops && !bin.empty(); ++i) {
+            std::uint32_t top = bin.top();
+            bin.pop();
+            sumBin += top;
+            for (int j = 0; j < 3 && bin.size() < 4096; ++j) bin.push(top + steps[k++ % steps.size()]);
+        }
+        double binMs = msSince(t0);
+
+        t0 = Clock::now();
+        RadixHeap<int> rad;
+        rad.push(0, 0);
+        std::uint64_t sumRad = 0;
+        for (int i = 0, k = 0; i < ops && !rad.empty(); ++i) {
+            std::uint32_t top;
+            rad.pop(&top);
+            sumRad += top;
+            for (int j = 0; j < 3 && rad.size() < 4096; ++j) rad.push(top + steps[k++ % steps.size()], 0);
+        }
+        double radMs = msSince(t0);
+
+        std::cout << "Queue ops (" << ops << " pops): binary heap " << binMs << " ms, radix heap " << radMs
+                  << " ms (x" << (radMs > 0 ? binMs / radMs : 0) << ")" << (sumBin == sumRad ? "" : " ORDER MISMATCH") << "\n";
+    }
+
+    void benchPqOn(const char* name, const Grid& g, int queries)
+    {
+        std::mt19937 rng(17);
+        std::vector<IVec2> enemies;
+        for (int i = 0; i < 6; ++i) enemies.push_back(randomOpenCell(g, rng));
+        auto risk = makeRisk(g, enemies, 0.05f);
+        const float alpha = 0.3f;
+
+        long long binNodes = 0, radNodes = 0;
+        double binMs = 0, radMs = 0, worst = 0;
+        for (int q = 0; q < queries; ++q) {
+            IVec2 a = randomOpenCell(g, rng), b = randomOpenCell(g, rng);
+            int expanded = 0;
+
+            auto t0 = Clock::now();
+            auto p1 = binaryHeapAStar(g, a, b, risk, alpha, expanded);
+            binMs += msSince(t0);
+            binNodes += expanded;
+
+            t0 = Clock::now();
+            auto p2 = aStarPath(g, a, b, risk, alpha, &expanded);
+            radMs += msSince(t0);
+            radNodes += expanded;
+
+            float c1 = pathCost(g, p1, risk, alpha);
+            if (c1 > 0) worst = std::max(worst, double(pathCost(g, p2, risk, alpha) / c1));
+        }
+        std::cout << name << " " << g.w << "x" << g.h << ": nodes binary " << binNodes << " vs radix " << radNodes
+                  << ", time " << binMs << " ms vs " << radMs << " ms (x" << (radMs > 0 ? binMs / radMs : 0)
+                  << "), worst cost ratio " << worst << "\n";
+    }
+
+    int benchPq(int tiles, int queries)
+    {
+        benchQueueOps(2000000);
+        Grid base = Grid::loadFromTxt("assets/sample_map_80x50.txt");
+        base.landmarks.reset();     // same heuristic as the baseline
+        benchPqOn("Sample", base, queries);
+        Grid big = tileGrid(base, tiles);
+        benchPqOn("Tiled", big, queries);
+        benchPqOn("Scattered 20%", scatterGrid(big.w, big.h, 20), queries);
+        return 0;
+    }
+
+    int benchSafe(int tiles, int units)
+    {
+        Grid g = tileGrid(Grid::loadFromTxt("assets/sample_map_80x50.txt"), tiles);
+        std::mt19937 rng(19);
+        std::vector<IVec2> enemies;
+        for (int i = 0; i < 6 * tiles * tiles; ++i) enemies.push_back(randomOpenCell(g, rng));
+        auto risk = makeRisk(g, enemies, 0.05f);
+
+        // Units stand near enemies, where retreats actually happen
+        std::vector<IVec2> unitsAt;
+        for (int i = 0; i < units; ++i) {
+            IVec2 e = enemies[i % enemies.size()];
+            IVec2 p{ std::clamp(e.x + (int)(rng() % 9) - 4, 0, g.w - 1), std::clamp(e.y + (int)(rng() % 9) - 4, 0, g.h - 1) };
+            unitsAt.push_back(g.passable(p) ? p : e);
+        }
+
+        const float maxRisk = 0.35f;
+        const int radius = 8;
+        const int ticks = 20;
+        int floodFound = 0, fieldFound = 0;
+
+        auto t0 = Clock::now();
+        for (int t = 0; t < ticks; ++t)
+            for (IVec2 p : unitsAt) floodFound += bfsFindSafe(g, p, risk, maxRisk, radius).has_value();
+        double floodMs = msSince(t0);
+
+        SafeField field;
+        field.reserve(units);
+        t0 = Clock::now();
+        for (int t = 0; t < ticks; ++t) {
+            field.update(g, risk, maxRisk, unitsAt.data(), unitsAt.size(), radius);
+            for (IVec2 p : unitsAt) fieldFound += field.nearest(p).has_value();
+        }
+        double fieldMs = msSince(t0);
+
+        // The field must give every unit the cell its own flood finds
+        int mismatches = 0;
+        for (IVec2 p : unitsAt)
+            if (field.nearest(p) != bfsFindSafe(g, p, risk, maxRisk, radius)) mismatches++;
+
+        std::cout << "Map " << g.w << "x" << g.h << ", " << units << " units, " << ticks << " ticks: floods "
+                  << floodMs << " ms, field " << fieldMs << " ms (x" << (fieldMs > 0 ? floodMs / fieldMs : 0)
+                  << "), found " << floodFound / ticks << " vs " << fieldFound / ticks << ", mismatches " << mismatches << "\n";
+        return mismatches ? 1 : 0;
+    }
+
+    // The risk map before cover-aware stamping: every enemy touches every cell
+    std::vector<float> fullGridRisk(const Grid& g, const std::vector<IVec2>& enemies, float base)
+    {
+        std::vector<float> r(g.w * g.h, base);
+        for (auto e : enemies)
+            for (int y = 0; y < g.h; ++y)
+                for (int x = 0; x < g.w; ++x) {
+                    float d = std::hypot(float(e.x - x), float(e.y - y));
+                    r[y * g.w + x] += d < 1.0f ? 1.0f : std::max(0.0f, 1.5f - d * 0.15f);
+                }
+        for (int i = 0; i < g.w * g.h; ++i)
+            if (g.cells[i] == Tile::Tree || g.cells[i] == Tile::Rock) r[i] *= 0.7f;
+        return r;
+    }
+
+    int benchRisk(int tiles, int enemyCount)
+    {
+        Grid g = tileGrid(Grid::loadFromTxt("assets/sample_map_80x50.txt"), tiles);
+        g.cover = buildCoverMap(g);
+        std::mt19937 rng(23);
+        std::vector<IVec2> enemies;
+        for (int i = 0; i < enemyCount; ++i) enemies.push_back(randomOpenCell(g, rng));
+
+        const int reps = 20;
+        auto t0 = Clock::now();
+        std::vector<float> oldRisk;
+        RiskMap newRisk;
+        for (int i = 0; i < reps; ++i) oldRisk = fullGridRisk(g, enemies, 0.05f);
+        double oldMs = msSince(t0) / reps;
+        t0 = Clock::now();
+        for (int i = 0; i < reps; ++i) newRisk = makeRisk(g, enemies, 0.05f);
+        double newMs = msSince(t0) / reps;
+
+        // Cells the old map called dangerous that are actually out of sight
+        int oldHot = 0, shadowed = 0;
+        for (int i = 0; i < g.w * g.h; ++i) {
+            if (oldRisk[i] <= 0.35f) continue;
+            oldHot++;
+            if (riskAt(newRisk, g, { i % g.w, i / g.w }) <= 0.35f) shadowed++;
+        }
+        std::cout << "Map " << g.w << "x" << g.h << ", " << enemyCount << " enemies: full grid " << oldMs
+                  << " ms, shadowcast " << newMs << " ms (x" << (newMs > 0 ? oldMs / newMs : 0) << "); "
+                  << shadowed << " of " << oldHot << " risky cells turn out to be in cover\n";
+        return 0;
+    }
+
+    // Risk updates as before chunking: a W*H layer rebuilt and diffed in full
+    std::vector<float> flatRisk(const Grid& g, const std::vector<IVec2>& enemies, float base)
+    {
+        std::vector<float> r(g.w * g.h);
+        for (int y = 0; y < g.h; ++y)
+            for (int x = 0; x < g.w; ++x) r[y * g.w + x] = base * coverAt(g, { x, y });
+        for (auto e : enemies)
+            shadowcast(g, e, 10, [&](IVec2 p) {
+                float d = std::hypot(float(e.x - p.x), float(e.y - p.y));
+                r[p.y * g.w + p.x] += (d < 1.0f ? 1.0f : std::max(0.0f, 1.5f - d * 0.15f)) * coverAt(g, p);
+            });
+        return r;
+    }
+
+    int benchChunks(int tiles, int enemyCount, int ticks)
+    {
+        Grid g = tileGrid(Grid::loadFromTxt("assets/sample_map_80x50.txt"), tiles);
+        g.cover = buildCoverMap(g);
+        std::mt19937 rng(31);
+        std::vector<IVec2> enemies;
+        for (int i = 0; i < enemyCount; ++i) enemies.push_back(randomOpenCell(g, rng));
+
+        std::vector<float> flat = flatRisk(g, enemies, 0.05f);
+        // Rebuilt into a second layer and swapped, as CommanderAI does, so
+        // chunk storage is reused
+        RiskMap chunked, next;
+        makeRisk(g, enemies, 0.05f, chunked);
+        double flatMs = 0, chunkMs = 0;
+        int mismatches = 0, peakChunks = 0;
+        for (int t = 0; t < ticks; ++t) {
+            for (auto& e : enemies) e = wander(g, e, rng);
+
+            auto t0 = Clock::now();
+            flat = flatRisk(g, enemies, 0.05f);
+            flatMs += msSince(t0);
+
+            t0 = Clock::now();
+            makeRisk(g, enemies, 0.05f, next);
+            std::swap(chunked, next);
+            chunkMs += msSince(t0);
+            peakChunks = std::max(peakChunks, chunked.allocatedChunks());
+        }
+
+        // Awake or asleep, every cell must agree with the flat layer exactly
+        for (int y = 0; y < g.h; ++y)
+            for (int x = 0; x < g.w; ++x)
+                if (riskAt(chunked, g, { x, y }) != flat[y * g.w + x]) mismatches++;
+
+        std::cout << "Map " << g.w << "x" << g.h << ", " << enemyCount << " enemies, " << ticks << " ticks: flat "
+                  << flatMs / ticks << " ms/tick, chunked " << chunkMs / ticks << " ms/tick (x"
+                  << (chunkMs > 0 ? flatMs / chunkMs : 0) << ")\n"
+                  << "Memory per team layer: flat " << g.w * g.h * sizeof(float) / 1024 << " KiB, chunked peak "
+                  << peakChunks << " of " << chunked.chunkCount() << " chunks = "
+                  << peakChunks * RiskMap::kChunkCells * sizeof(float) / 1024 << " KiB; mismatches " << mismatches << "\n";
+        return mismatches ? 1 : 0;
+    }
+
+    // Scaling curves on generated maps. Everything is seeded, so a run with
+    // the same arguments measures the same maps, queries and battles.
+    int benchScale(int maxSide, int warriors, unsigned seed)
+    {
+        std::cout << "side  gen ms  derived ms  A* ms/query  risk ms  LOS us/check  tick ms"
+                  << "  A* nodes/tick  LOS checks/tick  allocs/tick  (" << warriors
+                  << " warriors per team, seed " << seed << ")\n";
+        for (int side = 64; side <= maxSide; side *= 2) {
+            MapGenParams p;
+            p.w = p.h = side;
+            p.seed = seed;
+            auto t0 = Clock::now();
+            Grid g = generateMap(p);
+            double genMs = msSince(t0);
+            t0 = Clock::now();
+            Grid::buildDerived(g);
+            double derivedMs = msSince(t0);
+
+            Scenario sc = cornerScenario(g, baseSize(g), warriors);
+            std::string error;
+            if (!validateScenario(sc, g, error)) {
+                std::cerr << side << ": " << error << "\n";
+                return 1;
+            }
+            std::vector<IVec2> orangeSpots;
+            for (auto& u : sc.units)
+                if (u.team == Team::Orange) orangeSpots.push_back(u.pos);
+
+            t0 = Clock::now();
+            RiskMap risk = makeRisk(g, orangeSpots, 0.05f);
+            double riskMs = msSince(t0);
+
+            std::mt19937 rng(seed);
+            const int queries = 20;
+            t0 = Clock::now();
+            for (int q = 0; q < queries; ++q)
+                aStarPath(g, randomOpenCell(g, rng), randomOpenCell(g, rng), risk, 0.3f);
+            double pathMs = msSince(t0) / queries;
+
+            const int checks = 20000;
+            std::uniform_int_distribution<int> off(-kSightRange, kSightRange);
+            std::vector<std::pair<IVec2, IVec2>> pairs;
+            for (int i = 0; i < checks; ++i) {
+                IVec2 a = randomOpenCell(g, rng);
+                IVec2 b{ std::clamp(a.x + off(rng), 0, g.w - 1), std::clamp(a.y + off(rng), 0, g.h - 1) };
+                pairs.push_back({ a, b });
+            }
+            int visible = 0;
+            t0 = Clock::now();
+            for (auto& ab : pairs) visible += los(g, ab.first, ab.second);
+            double losUs = msSince(t0) * 1000.0 / checks;
+
+            // Full battle ticks, quiet so no console text is formatted
+            const int ticks = 50;
+            double tickMs;
+            MetricsSnapshot before, after;
+            {
+                Game game(g, sc);
+                game.setQuiet(true);
+                metrics::read(before);
+                t0 = Clock::now();
+                for (int t = 0; t < ticks && game.running; ++t) game.step();
+                tickMs = msSince(t0) / std::max(1, game.tick);
+                metrics::read(after);
+            }
+            MetricsSnapshot work = after.since(before);
+            double played = (double)std::max<std::uint64_t>(1, work[Counter::Ticks]);
+
+            std::cout << side << "  " << genMs << "  " << derivedMs << "  " << pathMs << "  " << riskMs << "  "
+                      << losUs << "  " << tickMs << "  " << work[Counter::AStarNodes] / played << "  "
+                      << work[Counter::LosChecks] / played << "  " << work[Counter::Allocations] / played << "\n";
+        }
+        return 0;
+    }
+
+    // Once caches, scratch buffers and arenas have grown to what the battle
+    // needs, a tick should not touch the global heap. Buffers reaching a new
+    // high-water mark still allocate now and then; a hot path allocating
+    // every tick shows up as most ticks allocating, which fails the run.
+    int benchAlloc(const std::string& path, int warmup, int ticks)
+    {
+        Scenario sc;
+        std::string error;
+        if (!loadScenario(path, sc, error) || !applyScenarioTunables(sc, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        Grid g = Grid::load(sc.map);
+        if (!validateScenario(sc, g, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+
+        // Quiet games: formatting the console text would allocate
+        MetricsSnapshot before, after;
+        int played, arenaBytes;
+        {
+            // A first game grows the per-thread search scratch
+            Game first(g, sc);
+            first.setQuiet(true);
+            while (first.running) first.step();
+        }
+        {
+            Game game(g, sc);
+            game.setQuiet(true);
+            for (int t = 0; t < warmup && game.running; ++t) game.step();
+            metrics::read(before);
+            for (int t = 0; t < ticks && game.running; ++t) game.step();
+            metrics::read(after);
+            played = game.tick - std::min(game.tick, warmup);
+            arenaBytes = (int)(game.blue.ai.arena.capacity() + game.orange.ai.arena.capacity());
+        }
+
+        MetricsSnapshot work = after.since(before);
+        const HistogramData& perTick = work[Histogram::TickAllocations];
+        std::uint64_t allocating = perTick.count - perTick.buckets[0];
+        bool ok = allocating == 0;
+        std::cout << (sc.name.empty() ? path : sc.name) << ": " << played << " ticks after " << warmup
+                  << " warm-up ticks\n"
+                  << "Allocations " << work[Counter::Allocations] << " (" << work[Counter::AllocatedBytes]
+                  << " bytes), ticks allocating " << allocating << ", per tick p50 " << perTick.quantile(0.5)
+                  << " p99 " << perTick.quantile(0.99) << " max " << perTick.quantile(1.0) << "\n"
+                  << "Tick arenas hold " << arenaBytes << " bytes\n";
+        if (played == 0) std::cout << "The game ended during the warm-up; nothing was measured\n";
+        if (!ok) std::cout << "FAIL: a warm tick allocated\n";
+        return ok ? 0 : 1;
+    }
+
+    // Everything a tick can change about the units and projectiles, hashed
+    std::uint64_t stateHash(const Game& game)
+    {
+        std::uint64_t h = 1469598103934665603ull;
+        auto mix = [&](std::int64_t v) { h = (h ^ (std::uint64_t)v) * 1099511628211ull; };
+        auto agent = [&](const Agent& a) {
+            mix(a.pos.x);
+            mix(a.pos.y);
+            mix(a.hp);
+            mix(a.ammo);
+            mix(a.grenades);
+            mix(a.alive * 2 + a.incapacitated);
+        };
+        for (const TeamState* ts : { &game.blue, &game.orange }) {
+            agent(ts->commander);
+            agent(ts->medic);
+            agent(ts->porter);
+            for (auto& w : ts->warriors) agent(w);
+            mix((int)ts->medic.state);
+        }
+        mix((std::int64_t)game.bullets.bullets.size());
+        mix((std::int64_t)game.grenades.grenades.size());
+        return h;
+    }
+
+    // Far warriors re-plan every lodInterval ticks whether or not the scans
+    // are skipped, and skipping only leaves out scans whose outcome the
+    // distances decide, so a game must play out tick for tick the same with
+    // the scans skipped and run. Full rate (lodDistance 0) plans every
+    // warrior every tick and is reported for comparison.
+    int benchLod(const std::vector<std::string>& paths)
+    {
+        const std::string lodDistance = std::to_string(tunables().lodDistance);
+        const std::string lodSkipScans = std::to_string(tunables().lodSkipScans);
+        int failed = 0;
+        for (auto& path : paths) {
+            Scenario sc;
+            std::string error;
+            if (!loadScenario(path, sc, error) || !applyScenarioTunables(sc, error)) {
+                std::cerr << error << "\n";
+                return 1;
+            }
+            Grid g = Grid::load(sc.map);
+            if (!validateScenario(sc, g, error)) {
+                std::cerr << error << "\n";
+                return 1;
+            }
+
+            struct Run {
+                std::vector<std::uint64_t> hashes;
+                std::uint64_t losChecks;
+                std::uint64_t searches;
+                double ms;
+            };
+            auto play = [&](const std::string& distance, const std::string& skip, Run& run) {
+                std::string err;
+                if (!applyTunables("lodDistance", distance, err) || !applyTunables("lodSkipScans", skip, err)) {
+                    std::cerr << err << "\n";
+                    return false;
+                }
+                MetricsSnapshot before, after;
+                Game game(g, sc);
+                game.setQuiet(true);
+                metrics::read(before);
+                auto t0 = Clock::now();
+                while (game.running) {
+                    game.step();
+                    run.hashes.push_back(stateHash(game));
+                }
+                run.ms = msSince(t0);
+                metrics::read(after);
+                MetricsSnapshot d = after.since(before);
+                run.losChecks = d[Counter::LosChecks];
+                run.searches = d[Counter::AStarCalls] + d[Counter::JpsCalls] + d[Counter::HpaCalls];
+                return true;
+            };
+
+            Run full, scanned, lod;
+            if (!play("0", lodSkipScans, full) || !play(lodDistance, "0", scanned) || !play(lodDistance, lodSkipScans, lod))
+                return 1;
+
+            std::size_t n = std::min(scanned.hashes.size(), lod.hashes.size()), diverged = n;
+            for (std::size_t t = 0; t < n && diverged == n; ++t)
+                if (scanned.hashes[t] != lod.hashes[t]) diverged = t;
+            bool same = diverged == n && scanned.hashes.size() == lod.hashes.size();
+
+            std::cout << (sc.name.empty() ? path : sc.name) << ": full rate " << full.hashes.size() << " ticks, "
+                      << full.searches << " path searches, " << full.ms << " ms; level of detail "
+                      << lod.hashes.size() << " ticks, " << lod.searches << " path searches, LOS checks "
+                      << scanned.losChecks << " -> " << lod.losChecks << " skipping scans, "
+                      << scanned.ms << " -> " << lod.ms << " ms\n";
+            if (!same) {
+                std::cout << "FAIL: skipping the scans changes the game from tick " << diverged << "\n";
+                failed++;
+            }
+        }
+        return failed ? 1 : 0;
+    }
+
+    // The text reader before the parallel importer: getline into strings,
+    // then a switch per character
+    Grid serialTextGrid(const std::string& path)
+    {
+        Grid g;
+        std::ifstream in(path);
+        std::vector<std::string> lines;
+        std::string s;
+        while (std::getline(in, s)) if (!s.empty()) lines.push_back(s);
+        g.h = (int)lines.size();
+        g.w = (int)(lines.empty() ? 0 : lines[0].size());
+        g.cells.assign(g.w * g.h, Tile::Open);
+        for (int y = 0; y < g.h; ++y)
+            for (int x = 0; x < g.w; ++x) {
+                Tile t = Tile::Open;
+                switch (lines[y][x]) {
+                case '#': t = Tile::Rock; break;
+                case 'T': t = Tile::Tree; break;
+                case '~': t = Tile::Water; break;
+                case 'A': t = Tile::DepotAmmo; g.blueAmmo = { x, y }; break;
+                case 'M': t = Tile::DepotMed; g.blueMed = { x, y }; break;
+                case 'a': t = Tile::DepotAmmo; g.orangeAmmo = { x, y }; break;
+                case 'm': t = Tile::DepotMed; g.orangeMed = { x, y }; break;
+                default: break;
+                }
+                g.cells[y * g.w + x] = t;
+            }
+        return g;
+    }
+
+    int benchMapIo(int tiles)
+    {
+        Grid g = tileGrid(Grid::loadFromTxt("assets/sample_map_80x50.txt"), tiles);
+        const std::string txt = "bench_map.txt", bin = "bench_map.aimap";
+        {
+            std::ofstream out(txt, std::ios::binary);
+            std::string line(g.w + 1, '\n');
+            for (int y = 0; y < g.h; ++y) {
+                for (int x = 0; x < g.w; ++x)
+                    line[x] = ".#T~AM"[(int)g.cells[y * g.w + x]];
+                out << line;
+            }
+        }
+
+        auto t0 = Clock::now();
+        Grid serial = serialTextGrid(txt);
+        double serialMs = msSince(t0);
+        t0 = Clock::now();
+        Grid parallel;
+        readAsciiMap(txt, parallel);
+        double parallelMs = msSince(t0);
+        bool same = serial.cells == parallel.cells;
+
+        // Full loads: text rebuilds every derived layer, the .aimap maps them
+        t0 = Clock::now();
+        Grid full = Grid::loadFromTxt(txt);
+        double fullTextMs = msSince(t0);
+        writeAimap(full, bin);
+        t0 = Clock::now();
+        Grid mapped = Grid::load(bin);
+        double fullBinMs = msSince(t0);
+        same = same && mapped.cells == full.cells && mapped.cover == full.cover &&
+               (!full.hpa || (mapped.hpa && mapped.hpa->inter == full.hpa->inter &&
+                              mapped.hpa->clusterSlot == full.hpa->clusterSlot));
+
+        std::remove(txt.c_str());
+        std::remove((txt + ".landmarks").c_str());
+        std::remove(bin.c_str());
+
+        std::cout << "Map " << g.w << "x" << g.h << ": tiles serial " << serialMs << " ms, parallel "
+                  << parallelMs << " ms (x" << (parallelMs > 0 ? serialMs / parallelMs : 0) << ")\n"
+                  << "Full load with derived layers: text " << fullTextMs << " ms, .aimap " << fullBinMs
+                  << " ms (x" << (fullBinMs > 0 ? fullTextMs / fullBinMs : 0) << ")"
+                  << (same ? "" : "  MISMATCH") << "\n";
+        return same ? 0 : 1;
+    }
+}
+
+int runBench(int argc, char* argv[])
+{
+    std::string suite = argc > 2 ? argv[2] : "hpa";
+    auto intArg = [&](int i, int def) { return argc > i ? std::atoi(argv[i]) : def; };
+
+    if (suite == "hpa")
+        return benchHpa(intArg(3, 8), intArg(4, 100));
+    if (suite == "alt")
+        return benchAlt(intArg(3, 1), intArg(4, 200));
+    if (suite == "jps")
+        return benchJps(intArg(3, 1), intArg(4, 200));
+    if (suite == "pq")
+        return benchPq(intArg(3, 8), intArg(4, 100));
+    if (suite == "safe")
+        return benchSafe(intArg(3, 1), intArg(4, 8));
+    if (suite == "risk")
+        return benchRisk(intArg(3, 1), intArg(4, 6));
+    if (suite == "mapio")
+        return benchMapIo(intArg(3, 8));
+    if (suite == "chunks")
+        return benchChunks(intArg(3, 8), intArg(4, 12), 50);
+    if (suite == "scale")
+        return benchScale(intArg(3, 1024), intArg(4, 8), (unsigned)intArg(5, 1));
+    if (suite == "alloc")
+        return benchAlloc(argc > 3 ? argv[3] : "assets/balanced.scenario", intArg(4, 300), intArg(5, 1000));
+    if (suite == "lod") {
+        std::vector<std::string> paths(argv + std::min(argc, 3), argv + argc);
+        if (paths.empty())
+            paths = { "assets/balanced.scenario", "assets/blue_advantage.scenario", "assets/orange_advantage.scenario" };
+        return benchLod(paths);
+    }
+
+    std::cerr << "Unknown bench suite '" << suite << "'\n";
+    return 2;
+}
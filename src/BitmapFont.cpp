@@ -0,0 +1,92 @@
+// BitmapFont.cpp - The built-in 3x5 font and its atlas
+// Glyphs are written as five octal digits, one per row, top row first.
+
+#include "BitmapFont.h"
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+    // ASCII 32..127; 127 is the solid block used for untextured quads
+    const std::uint16_t kGlyphs[96] = {
+        000000, 022202, 055000, 057575, 036236, 051245, 025253, 022000, // space ! " # $ % & '
+        012221, 042224, 005250, 002720, 000024, 000700, 000002, 011244, // ( ) * + , - . /
+        075557, 026227, 071747, 071717, 055711, 074717, 074757, 071111, // 0 - 7
+        075757, 075717, 002020, 002024, 012421, 007070, 042124, 071202, // 8 9 : ; < = > ?
+        075747, 025755, 065656, 034443, 065556, 074647, 074644, 034553, // @ A - G
+        055755, 072227, 011152, 055655, 044447, 057755, 065555, 025552, // H - O
+        065644, 025563, 065655, 034216, 072222, 055557, 055552, 055775, // P - W
+        055255, 055222, 071247, 064446, 044211, 031113, 025000, 000007, // X Y Z [ \ ] ^ _
+        042000, 025755, 065656, 034443, 065556, 074647, 074644, 034553, // ` then lower case
+        055755, 072227, 011152, 055655, 044447, 057755, 065555, 025552,
+        065644, 025563, 065655, 034216, 072222, 055557, 055552, 055775,
+        055255, 055222, 071247, 032623, 022222, 062326, 003600, 077777, // x y z { | } ~ solid
+    };
+}
+
+std::uint16_t fontGlyph(char c)
+{
+    int i = (unsigned char)c;
+    return i >= 32 && i < 128 ? kGlyphs[i - 32] : kGlyphs['?' - 32];
+}
+
+FontAtlas::FontAtlas()
+    : alpha((std::size_t)kWidth * kHeight, 0)
+{
+    for (int i = 0; i < 96; ++i) {
+        int cx = (i % kCols) * kFontAdvance, cy = (i / kCols) * kFontLine;
+        std::uint16_t bits = kGlyphs[i];
+        for (int row = 0; row < kFontH; ++row)
+            for (int col = 0; col < kFontW; ++col)
+                if (bits >> ((kFontH - 1 - row) * 3 + (kFontW - 1 - col)) & 1)
+                    alpha[(std::size_t)(cy + row) * kWidth + cx + col] = 255;
+    }
+}
+
+void FontAtlas::uv(char c, float& u0, float& v0, float& u1, float& v1)
+{
+    int i = (unsigned char)c;
+    if (i < 32 || i >= 127) i = '?';
+    i -= 32;
+    int cx = (i % kCols) * kFontAdvance, cy = (i / kCols) * kFontLine;
+    u0 = (float)cx / kWidth;
+    v0 = (float)cy / kHeight;
+    u1 = (float)(cx + kFontW) / kWidth;
+    v1 = (float)(cy + kFontH) / kHeight;
+}
+
+TextLine& TextLine::operator<<(const char* s)
+{
+    while (*s && len < (int)sizeof(text) - 1) text[len++] = *s++;
+    text[len] = '\0';
+    return *this;
+}
+
+TextLine& TextLine::operator<<(char c)
+{
+    if (len < (int)sizeof(text) - 1) text[len++] = c;
+    text[len] = '\0';
+    return *this;
+}
+
+TextLine& TextLine::operator<<(int v)
+{
+    auto r = std::to_chars(text + len, text + sizeof(text) - 1, v);
+    if (r.ec == std::errc()) len = (int)(r.ptr - text);
+    text[len] = '\0';
+    return *this;
+}
+
+TextLine& TextLine::fixed(double v, int decimals)
+{
+    static const int kScale[] = { 1, 10, 100, 1000 };
+    int scale = kScale[decimals < 0 ? 0 : decimals > 3 ? 3 : decimals];
+    long long n = std::llround(std::fabs(v) * scale);
+    if (v < 0 && n > 0) *this << '-';
+    *this << (int)(n / scale);
+    if (scale > 1) {
+        *this << '.';
+        for (int s = scale / 10; s > 0; s /= 10) *this << (char)('0' + n / s % 10);
+    }
+    return *this;
+}
@@ -24,9 +24,11 @@ Bullet::Bullet(float sx, float sy, float tx, float ty)
 void Bullet::update(const Grid& g)
 {
     // Trail
-    trail.emplace_back(x, y);
-    if (trail.size() > 10)
-        trail.erase(trail.begin());
+    if (trailLength == kBulletTrailLength)
+        std::move(trail.begin() + 1, trail.end(), trail.begin());
+    else
+        trailLength++;
+    trail[trailLength - 1] = { x, y };
 
     float nx = x + dx * speed;
     float ny = y + dy * speed;
@@ -8,8 +8,23 @@
 
 #include "CommanderAI.h"
 #include "Visibility.h"
+#include "TaskPool.h"
+#include "PathService.h"
+#include "Profiler.h"
 #include <algorithm>
 #include <iostream>
+#include <sstream>
+
+namespace
+{
+    void logPath(std::ostream* log, const std::vector<IVec2>& path)
+    {
+        if (log) {
+            *log << "  -> Path found: " << (path.size() > 1 ? "YES" : "NO") 
+                      << " (size=" << path.size() << ")\n";
+        }
+    }
+}
 
 void CommanderAI::step(const Grid& g,
     Commander& c,
@@ -17,22 +32,65 @@ void CommanderAI::step(const Grid& g,
     Medic& med,
     Porter& port,
     const std::vector<IVec2>& enemySpots,
-    int tick)
+    int tick,
+    CommanderState* state)
 {
     if (!c.alive) return;
 
-    auto risk = makeRisk(g, enemySpots, 0.05f);
+    // Teams may run concurrently, so with state events are staged and the
+    // output is buffered; Game commits both in a fixed team order after both
+    // teams have finished. Without state they go straight to the console.
+    std::ostream& out = state ? static_cast<std::ostream&>(state->log) : std::cout;
+    auto emit = [&](const GameEvent& e) {
+        if (state) state->events.push_back(e);
+        else printEvent(out, e);
+    };
+    const bool chatter = !state || !state->quiet;
+
+    // Without persistent state every scan runs every tick (legacy polling)
+    if (state) state->sched.advance(tick);
+    auto scanAwake = [&](int watcher) { return !state || state->sched.awake(watcher); };
+
+    PROFILE_BEGIN(riskZone, "risk");
+    RiskMap freshRisk;
+    if (!state) {
+        freshRisk = makeRisk(g, enemySpots, 0.05f);
+    }
+    else if (!state->riskValid || state->riskSpots != enemySpots) {
+        // Rebuilt into the spare map, whose chunks are reused, then swapped in
+        RiskMap& rebuilt = state->riskNext;
+        makeRisk(g, enemySpots, 0.05f, rebuilt);
+        std::swap(state->risk, rebuilt);
+        state->riskSpots = enemySpots;
+        state->riskValid = true;
+    }
+    const RiskMap& risk = state ? state->risk : freshRisk;
+    PROFILE_END(riskZone);
+
+    // All path queries of this step go through the path service and are
+    // solved together at the barrier below; callbacks apply the moves.
+    PathService localPaths;
+    PathService& paths = state ? state->paths : localPaths;
+    auto stepAlong = [](IVec2& pos) {
+        return [&pos](const std::vector<IVec2>& path) {
+            if (path.size() > 1) pos = path[1];
+        };
+    };
 
     // ========================================
     // 1. HEALING - Check ALL warriors
     // ========================================
 
-    // If medic is already busy, skip
-    if (med.alive && med.state == Medic::State::Idle)
+    // If medic is already busy, skip. An idle medic only rescans after a
+    // warrior took damage or the medic itself just came back from a mission.
+    PROFILE_BEGIN(heal, "heal");
+    if (med.alive && med.state == Medic::State::Idle && scanAwake(state ? state->healWatch : 0))
     {
+        if (state) state->sched.sleep(state->healWatch);
+
         // Find most injured warrior that needs healing (including incapacitated ones at 0 HP)
         Warrior* targetWarrior = nullptr;
-        int lowestHP = kMedCallHP;  // Only heal if below 60 HP
+        int lowestHP = tunables().medCallHP;  // Only heal if below medCallHP
 
         for (auto& w : warriors)
         {
@@ -56,7 +114,9 @@ void CommanderAI::step(const Grid& g,
         {
             med.state = Medic::State::GoingToDepot;
             med.targetPatient = targetWarrior->pos;
-            std::cout << "[MEDIC] " << teamName(c.team) << " dispatching medic (warrior HP=" << lowestHP << ")\n";
+            GameEvent e = GameEvent::make(GameEventType::MedicDispatched, tick);
+            e.medic = { eventUnit(c.team, Role::Medic, med.pos), eventUnit(c.team, Role::Warrior, targetWarrior->pos), (std::int16_t)lowestHP };
+            emit(e);
         }
     }
 
@@ -74,10 +134,7 @@ void CommanderAI::step(const Grid& g,
             }
             else
             {
-                auto path = aStarPath(g, med.pos, depot, risk, 0.3f);
-                if (path.size() > 1) {
-                    med.pos = path[1];
-                }
+                paths.request({ med.pos, depot, &risk, 0.3f }, stepAlong(med.pos));
             }
             break;
 
@@ -112,6 +169,7 @@ void CommanderAI::step(const Grid& g,
             {
                 // No injured warriors found, abort mission
                 med.state = Medic::State::Idle;
+                if (state) state->sched.wake(state->healWatch);
                 break;
             }
 
@@ -120,22 +178,28 @@ void CommanderAI::step(const Grid& g,
             {
                 // Start healing
                 med.state = Medic::State::Healing;
+                GameEvent e = GameEvent::make(GameEventType::Heal, tick);
                 if (patient->incapacitated) {
                     // Revive incapacitated warrior
-                    patient->revive(100);
-                    std::cout << "[MEDIC] REVIVED " << teamName(c.team) << " warrior from 0 HP to 100 HP!\n";
+                    patient->revive(tunables().reviveHP);
+                    if (state && !patient->incapacitated) state->sched.post(AgentEvent::Revived);
+                    e.type = GameEventType::Revive;
                 } else {
                     // Regular healing
                     patient->hp = 100;
-                    std::cout << "[MEDIC] Healed " << teamName(c.team) << " warrior to HP=100!\n";
+                }
+                e.medic = { eventUnit(c.team, Role::Medic, med.pos), eventUnit(c.team, Role::Warrior, patient->pos), (std::int16_t)patient->hp };
+                emit(e);
+                // Out of revives: the warrior is gone for good
+                if (!patient->alive && !patient->incapacitated) {
+                    GameEvent d = GameEvent::make(GameEventType::Death, tick);
+                    d.death = { eventUnit(c.team, Role::Warrior, patient->pos), true };
+                    emit(d);
                 }
             }
             else
             {
-                auto path = aStarPath(g, med.pos, patient->pos, risk, 0.3f);
-                if (path.size() > 1) {
-                    med.pos = path[1];
-                }
+                paths.request({ med.pos, patient->pos, &risk, 0.3f }, stepAlong(med.pos));
             }
             break;
         }
@@ -143,39 +207,48 @@ void CommanderAI::step(const Grid& g,
         case Medic::State::Healing:
             // Healing complete, go idle
             med.state = Medic::State::Idle;
+            if (state) state->sched.wake(state->healWatch);
             break;
         }
     }
+    PROFILE_END(heal);
 
     // ========================================
     // 2. RESUPPLY - Check ALL warriors  
     // ========================================
-    bool porterBusy = false;
+    // The scan sleeps once it finds nobody to resupply; ammo running low,
+    // a revive or a resupply cooldown expiring wakes it again.
+    PROFILE_BEGIN(resupply, "resupply");
+    bool resupplyScan = scanAwake(state ? state->resupplyWatch : 0);
 
     // First pass: Find warriors that are COMPLETELY out of ammo (priority)
     Warrior* urgentWarrior = nullptr;
     for (auto& w : warriors)
     {
+        if (!resupplyScan) break;
         if (!w.alive || w.incapacitated) continue;
-        if ((w.ammo == 0 && w.grenades == 0) && (tick - w.lastResupplyTick) >= kPorterCooldown) {
+        if ((w.ammo == 0 && w.grenades == 0) && (tick - w.lastResupplyTick) >= tunables().porterCooldown) {
             urgentWarrior = &w;
             break; // Found urgent case
         }
     }
 
     // Second pass: If no urgent case, check for low ammo
-    if (!urgentWarrior) {
+    if (!urgentWarrior && resupplyScan) {
         for (auto& w : warriors)
         {
             if (!w.alive || w.incapacitated) continue;
-            bool needsResupply = (w.ammo == 0 || w.grenades == 0) || (w.ammo < kLowAmmo);
-            if (needsResupply && (tick - w.lastResupplyTick) >= kPorterCooldown) {
+            bool needsResupply = (w.ammo == 0 || w.grenades == 0) || (w.ammo < tunables().lowAmmo);
+            if (needsResupply && (tick - w.lastResupplyTick) >= tunables().porterCooldown) {
                 urgentWarrior = &w;
                 break;
             }
         }
     }
 
+    if (state && resupplyScan && !urgentWarrior)
+        state->sched.sleep(state->resupplyWatch);
+
     // Execute resupply mission if we found a warrior
     if (urgentWarrior && port.alive)
     {
@@ -186,72 +259,107 @@ void CommanderAI::step(const Grid& g,
         // If near depot (within 10 tiles), can resupply from long distance (50 tiles)
         if (distToDepot <= 10 && distToWarrior <= 50)
         {
-            urgentWarrior->ammo = 20;  // Full resupply
-            urgentWarrior->grenades = 2;
+            urgentWarrior->ammo = tunables().resupplyAmmo;  // Full resupply
+            urgentWarrior->grenades = tunables().resupplyGrenades;
             urgentWarrior->lastResupplyTick = tick; // Mark resupply time
-            porterBusy = true;
-            std::cout << "🔫 Porter resupplied " << teamName(c.team) 
-                      << " warrior at tick " << tick << " (next at " << (tick + kPorterCooldown) << ")\n";
+            if (state) state->sched.wakeAt(tick + tunables().porterCooldown, AgentEvent::CooldownExpired);
+            GameEvent e = GameEvent::make(GameEventType::Resupply, tick);
+            e.resupply = { eventUnit(c.team, Role::Porter, port.pos), eventUnit(c.team, Role::Warrior, urgentWarrior->pos),
+                           tick + tunables().porterCooldown };
+            emit(e);
         }
         // Move toward depot to get supplies
         else if (distToDepot > 5)
         {
-            auto path = aStarPath(g, port.pos, depot, risk, 0.3f);
-            if (path.size() > 1) {
-                port.pos = path[1];
-                porterBusy = true;
-            }
+            paths.request({ port.pos, depot, &risk, 0.3f }, stepAlong(port.pos));
         }
         // At depot, move toward warrior
         else
         {
-            auto path = aStarPath(g, port.pos, urgentWarrior->pos, risk, 0.3f);
-            if (path.size() > 1) {
-                port.pos = path[1];
-                porterBusy = true;
-            }
+            paths.request({ port.pos, urgentWarrior->pos, &risk, 0.3f }, stepAlong(port.pos));
         }
     }
+    PROFILE_END(resupply);
 
     // ========================================
     // 3. WARRIOR TACTICAL MOVEMENT
     // ========================================
-    bool forceCommanderFocus = tick >= kForceCommanderFocusTick; // NEW
+    bool forceCommanderFocus = tick >= tunables().forceCommanderFocusTick; // NEW
+    const bool lod = tunables().lodDistance > 0 && tunables().lodSkipScans;
+    // Nothing farther than this can be shot at or change the decision to advance
+    const int lodReach = std::max({ tunables().lodDistance, tunables().grenadeRange,
+                                    tunables().gunRange, tunables().advanceRange });
     // Warriors decide: Defend (if low HP/high risk) OR Advance (if healthy) OR Hold position (in combat range)
-    
-    static int moveLogCounter = 0;
-    moveLogCounter++;
-    bool shouldLog = (moveLogCounter % 50 == 0); // Log movement every 50 moves
-    
-    for (auto& w : warriors)
+    // Each warrior only reads shared tick state and writes itself, so large
+    // squads are planned in parallel. Output is kept per warrior until the
+    // path barrier so it comes out in warrior order.
+    auto followPath = [](Warrior& w) {
+        return [&w](const std::vector<IVec2>& path) {
+            if (path.size() > 1) w.pos = path[1];
+        };
+    };
+
+    if (state) state->routes.resize(warriors.size());
+
+    // Critically hurt warriors retreat to the nearest cell at or below
+    // warriorSafeRisk, solved once per cell they stand on before they think
+    const float warriorSafeRisk = 0.35f;
+    const int warriorSafeRadius = 8;
+    bool safeField = false;
+    if (state) {
+        state->warriorSafe.reserve((int)warriors.size());
+        std::pmr::vector<IVec2> critical(&state->arena);
+        for (auto& w : warriors)
+            if (w.alive && !w.incapacitated && w.hp <= 25) critical.push_back(w.pos);
+        safeField = !critical.empty();
+        if (safeField) {
+            PROFILE_ZONE("warrior safe field");
+            state->warriorSafe.update(g, risk, warriorSafeRisk, critical.data(), critical.size(), warriorSafeRadius);
+        }
+    }
+
+    auto thinkWarrior = [&](Warrior& w, WarriorRoute* route, std::ostream& wout)
     {
-        if (!w.alive || w.incapacitated) continue; // Skip dead and incapacitated warriors
+        if (!w.alive || w.incapacitated) return; // Skip dead and incapacitated warriors
 
-        float currentRisk = riskAt(risk, g, w.pos);
-        
         // If forcing commander focus, override enemySpots to just commander
-        std::vector<IVec2> focusSpots = enemySpots;
-        if (forceCommanderFocus) {
-            focusSpots.clear();
-            // Push enemy commander position if known
-            if (!enemySpots.empty()) {
-                // enemySpots originally includes commander first if alive
-                focusSpots.push_back(enemySpots.front());
-            }
+        // (enemySpots includes the commander first if alive)
+        const IVec2* focusBegin = enemySpots.data();
+        const IVec2* focusEnd = focusBegin + (forceCommanderFocus ? std::min<size_t>(1, enemySpots.size()) : enemySpots.size());
+
+        // Level of detail: with no enemy within reach a healthy warrior can
+        // only advance, so between re-plans it steps along its last route.
+        // An enemy coming within reach drops the route (promotion).
+        bool far = route && tunables().lodDistance > 0 && focusBegin != focusEnd && w.hp > 25 &&
+                   !(w.ammo == 0 && w.grenades == 0) &&
+                   std::none_of(focusBegin, focusEnd, [&](IVec2 e) { return w.pos.manhattan(e) <= lodReach; });
+        if (route && !far) route->path.clear();
+        bool cruising = far && route->next + 1 < route->path.size() && route->path[route->next] == w.pos &&
+                        tick - route->planned < tunables().lodInterval;
+        auto cruise = [&] { w.pos = route->path[++route->next]; };
+        // The scans below would only confirm the advance, unless chatter logs it
+        if (cruising && lod && !(chatter && tick % 500 == 0)) {
+            cruise();
+            return;
         }
+
+        float currentRisk = riskAt(risk, g, w.pos);
         
         bool inCombatRange = false;
         int closestEnemyDist = 9999;
         IVec2 closestEnemy;
 
-        for (auto enemy : focusSpots) {
+        for (const IVec2* it = focusBegin; it != focusEnd; ++it) {
+            IVec2 enemy = *it;
             int dist = w.pos.manhattan(enemy);
             if (dist < closestEnemyDist) {
                 closestEnemyDist = dist;
                 closestEnemy = enemy;
             }
-            bool hasLOS = los(g, w.pos, enemy);
-            if (dist <= kGunRange && hasLOS) {
+            // LOS only matters inside gun range; level of detail skips
+            // tracing it to anyone farther
+            if (lod && dist > tunables().gunRange) continue;
+            if (los(g, w.pos, enemy) && dist <= tunables().gunRange) {
                 inCombatRange = true;
             }
         }
@@ -261,15 +369,12 @@ void CommanderAI::step(const Grid& g,
         
         if (criticalDanger)
         {
-            auto safeOpt = bfsFindSafe(g, w.pos, risk, 0.35f, 8);
+            auto safeOpt = safeField ? state->warriorSafe.nearest(w.pos)
+                                     : bfsFindSafe(g, w.pos, risk, warriorSafeRisk, warriorSafeRadius);
 
             if (safeOpt && *safeOpt != w.pos)
             {
-                auto path = aStarPath(g, w.pos, *safeOpt, risk, 0.7f);
-                if (path.size() > 1)
-                {
-                    w.pos = path[1];
-                }
+                paths.request({ w.pos, *safeOpt, &risk, 0.7f }, followPath(w));
             }
         }
         
@@ -277,7 +382,7 @@ void CommanderAI::step(const Grid& g,
         if (inCombatRange && w.ammo > 0 && w.hp > 25)
         {
             // Don't log every tick - too spammy
-            continue; // Don't move, stay and shoot
+            return; // Don't move, stay and shoot
         }
         
         // PRIORITY 3: Advance toward enemies if not in critical danger and not in combat range
@@ -294,14 +399,14 @@ void CommanderAI::step(const Grid& g,
             // - Keep advancing if far away (>9)
             // - OR if we're out of grenades and not yet in gun range
             // - BUT NOT if totally out of ammo (hold position and wait for resupply)
-            bool needToCloseIn = (w.grenades == 0 && closestEnemyDist > kGunRange && w.ammo > 0);
+            bool needToCloseIn = (w.grenades == 0 && closestEnemyDist > tunables().gunRange && w.ammo > 0);
             bool totallyOutOfAmmo = (w.ammo == 0 && w.grenades == 0);
-            // Change: Advance if distance > kGrenadeRange (10) OR if out of grenades and not in gun range
+            // Change: Advance if distance > advanceRange OR if out of grenades and not in gun range
             // BUT: Don't advance if totally out of ammo - stay put and wait for resupply
-            bool shouldAdvance = (w.hp > 25) && !totallyOutOfAmmo && ((closestEnemyDist > kGrenadeRange) || needToCloseIn);
+            bool shouldAdvance = (w.hp > 25) && !totallyOutOfAmmo && ((closestEnemyDist > tunables().advanceRange) || needToCloseIn);
             
-            if (tick % 500 == 0) {
-                std::cout << "[MOVE] " << teamName(c.team) << " warrior at (" << w.pos.x << "," << w.pos.y << ")"
+            if (chatter && tick % 500 == 0) {
+                wout << "[MOVE] " << teamName(c.team) << " warrior at (" << w.pos.x << "," << w.pos.y << ")"
                           << " distToEnemy=" << closestEnemyDist 
                           << " HP=" << w.hp 
                           << " Ammo=" << w.ammo
@@ -310,25 +415,57 @@ void CommanderAI::step(const Grid& g,
                           << " shouldAdvance=" << (shouldAdvance ? "YES" : "NO") << "\n";
             }
             
-            if (shouldAdvance)
+            if (shouldAdvance && cruising)
             {
-                auto path = aStarPath(g, w.pos, closestEnemy, risk, 0.3f);
-                if (tick % 500 == 0) {
-                    std::cout << "  -> Path found: " << (path.size() > 1 ? "YES" : "NO") 
-                              << " (size=" << path.size() << ")\n";
-                }
-                if (path.size() > 1)
-                {
-                    w.pos = path[1];
-                }
+                cruise();
+            }
+            else if (shouldAdvance && far)
+            {
+                // Two pointers, so std::function stores it without allocating
+                route->owner = &w;
+                route->planned = tick;
+                auto onRoute = [route, log = chatter && tick % 500 == 0 ? &wout : nullptr](const std::vector<IVec2>& path) {
+                    logPath(log, path);
+                    route->path.assign(path.begin(), path.end());
+                    route->next = path.size() > 1 ? 1 : 0;
+                    if (path.size() > 1) route->owner->pos = path[1];
+                };
+                paths.request({ w.pos, closestEnemy, &risk, 0.3f }, onRoute);
+            }
+            else if (shouldAdvance)
+            {
+                auto onPath = [follow = followPath(w), log = chatter && tick % 500 == 0 ? &wout : nullptr](const std::vector<IVec2>& path) {
+                    logPath(log, path);
+                    follow(path);
+                };
+                paths.request({ w.pos, closestEnemy, &risk, 0.3f }, onPath);
             }
         }
+    };
+
+    PROFILE_BEGIN(warriorZone, "warriors");
+    std::pmr::memory_resource* scratch = state ? &state->arena : std::pmr::get_default_resource();
+    std::pmr::vector<std::stringstream> warriorLogs(warriors.size(), scratch);
+    if ((int)warriors.size() >= kParallelWarriorBatch)
+    {
+        TaskPool::shared().parallelFor((int)warriors.size(), [&](int i) {
+            thinkWarrior(warriors[i], state ? &state->routes[i] : nullptr, warriorLogs[i]);
+        });
     }
+    else
+    {
+        for (size_t i = 0; i < warriors.size(); ++i)
+            thinkWarrior(warriors[i], state ? &state->routes[i] : nullptr, warriorLogs[i]);
+    }
+    PROFILE_END(warriorZone);
+
     // ========================================
     // 5. COMMANDER SURVIVAL (Retreat to Safety)
     // ========================================
     
     // Commander cannot attack per requirements, only move to safety
+    PROFILE_BEGIN(safety, "commander safety");
+    bool commanderMoved = false;
     if (!enemySpots.empty()) {
         float commanderRisk = riskAt(risk, g, c.pos);
         
@@ -337,20 +474,35 @@ void CommanderAI::step(const Grid& g,
             auto safeOpt = bfsFindSafe(g, c.pos, risk, 0.3f, 10);
             
             if (safeOpt && *safeOpt != c.pos) {
-                auto path = aStarPath(g, c.pos, *safeOpt, risk, 0.8f);
-                if (path.size() > 1) {
-                    c.pos = path[1];
-                    std::cout << "[COMMANDER] Moving to safer position!\n";
-                }
+                paths.request({ c.pos, *safeOpt, &risk, 0.8f },
+                    [&c, &commanderMoved](const std::vector<IVec2>& path) {
+                        if (path.size() > 1) {
+                            c.pos = path[1];
+                            commanderMoved = true;
+                        }
+                    });
             }
         }
     }
     
+    PROFILE_END(safety);
+
+    // Barrier: solve every queued path and apply the moves
+    PROFILE_BEGIN(pathZone, "paths.flush");
+    paths.flush(g, scratch);
+    PROFILE_END(pathZone);
+    // Streaming the buffer copies nothing, unlike str(). It has to be
+    // readable (a stringstream), and an empty one would set failbit on out.
+    for (auto& l : warriorLogs)
+        if (l.tellp() > 0) out << l.rdbuf();
+    if (commanderMoved && chatter) out << "[COMMANDER] Moving to safer position!\n";
+
     // ========================================
     // 6. BUILD VISIBILITY MAP
     // ========================================
     
     // Commander combines all soldiers' visibility
+    PROFILE_ZONE("visibility map");
     c.visibilityMap.clear();
     for (auto& w : warriors) {
         // Include warriors even if incapacitated so commander tracks them
@@ -0,0 +1,258 @@
+// ConsoleRenderer.cpp - ANSI terminal view for the console build
+// Keeps a shadow copy of the glyph grid on screen and sends only the cells
+// that changed, as one write() per frame.
+
+#include "Renderer.h"
+#include "SimThread.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace
+{
+    // SGR sequences, indexed by Cell::color
+    enum Color : std::uint8_t { Plain, Rock, Tree, Water, Depot, Blue, Orange, Down, Bullet, Trail, Grenade, Status };
+    const char* const kSgr[] = {
+        "\x1b[0m",          // Plain
+        "\x1b[0;90m",       // Rock
+        "\x1b[0;32m",       // Tree
+        "\x1b[0;34m",       // Water
+        "\x1b[0;33m",       // Depot
+        "\x1b[0;1;94m",     // Blue
+        "\x1b[0;1;38;5;208m", // Orange
+        "\x1b[0;1;91m",     // Down
+        "\x1b[0;1;93m",     // Bullet
+        "\x1b[0;33m",       // Trail
+        "\x1b[0;1;31m",     // Grenade
+        "\x1b[0;7m",        // Status
+    };
+
+    struct Cell {
+        char ch;
+        std::uint8_t color;
+        bool operator!=(const Cell& o) const { return ch != o.ch || color != o.color; }
+    };
+
+    Cell tileCell(Tile t)
+    {
+        switch (t) {
+        case Tile::Rock:      return { '#', Rock };
+        case Tile::Tree:      return { 'T', Tree };
+        case Tile::Water:     return { '~', Water };
+        case Tile::DepotAmmo: return { 'A', Depot };
+        case Tile::DepotMed:  return { '+', Depot };
+        default:              return { ' ', Plain };
+        }
+    }
+
+    std::atomic<bool> interrupted{ false };
+    void onInterrupt(int) { interrupted = true; }
+
+    // Terminal size in cells, or false when stdout is not a terminal
+    bool terminalSize(int& cols, int& rows)
+    {
+#ifdef _WIN32
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) return false;
+        cols = info.srWindow.Right - info.srWindow.Left + 1;
+        rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+        return true;
+#else
+        winsize ws{};
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0 || ws.ws_col == 0) return false;
+        cols = ws.ws_col;
+        rows = ws.ws_row;
+        return true;
+#endif
+    }
+
+    // All of s, straight to the terminal: no stdio buffer, no locale
+    void writeAll(const std::string& s)
+    {
+        const char* p = s.data();
+        std::size_t left = s.size();
+        while (left > 0) {
+#ifdef _WIN32
+            int n = _write(1, p, (unsigned)std::min<std::size_t>(left, 1 << 20));
+#else
+            ssize_t n = ::write(STDOUT_FILENO, p, left);
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n <= 0) return;
+            p += n;
+            left -= (std::size_t)n;
+        }
+    }
+
+    class ConsoleView {
+    public:
+        // Viewport of the map's top-left corner that fits the terminal, plus
+        // a status line; rebuilt (and fully redrawn) when the terminal resizes
+        void resize(const Grid& g)
+        {
+            int cols = g.w, rows = g.h + 1;
+            if (terminalSize(cols, rows)) {
+                cols = std::min(cols, g.w);
+                rows = std::min(rows - 1, g.h) + 1;
+            }
+            cols = std::max(cols, 1);
+            rows = std::max(rows, 2);
+            if (cols == w && rows == h) return;
+            w = cols;
+            h = rows;
+            next.assign((std::size_t)w * h, Cell{ ' ', Plain });
+            // Nothing on screen matches, so the first frame sends every cell
+            shadow.assign((std::size_t)w * h, Cell{ 0, 0 });
+            out += "\x1b[0m\x1b[2J";
+        }
+
+        void compose(const Grid& g, const RenderSnapshot& snap, const char* status)
+        {
+            const int mapRows = h - 1;
+            for (int y = 0; y < mapRows; ++y)
+                for (int x = 0; x < w; ++x)
+                    next[(std::size_t)y * w + x] = tileCell(g.cells[(std::size_t)y * g.w + x]);
+            auto put = [&](float fx, float fy, Cell c) {
+                int x = (int)fx, y = (int)fy;
+                if (x >= 0 && y >= 0 && x < w && y < mapRows) next[(std::size_t)y * w + x] = c;
+            };
+            for (const auto& t : snap.trails) put(t.x, t.y, Cell{ '.', Trail });
+            for (const auto& b : snap.bullets) put(b.x, b.y, Cell{ '*', Bullet });
+            for (const auto& gr : snap.grenades) put(gr.x, gr.y, Cell{ 'o', Grenade });
+            for (const auto& a : snap.agents) {
+                if (!a.alive) continue;
+                put(a.x, a.y, Cell{ a.glyph, a.incapacitated ? Down : a.team == Team::Blue ? Blue : Orange });
+            }
+            Cell* line = &next[(std::size_t)mapRows * w];
+            int x = 0;
+            for (; x < w && status[x]; ++x) line[x] = Cell{ status[x], Status };
+            for (; x < w; ++x) line[x] = Cell{ ' ', Plain };
+        }
+
+        // Escape codes for every cell that differs from the screen; the cursor
+        // only moves to skip unchanged cells and colours only change when needed
+        void diff()
+        {
+            int cx = -1, cy = -1, color = -1;
+            char move[24];
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    std::size_t i = (std::size_t)y * w + x;
+                    if (!(next[i] != shadow[i])) continue;
+                    if (x != cx || y != cy) {
+                        int n = std::snprintf(move, sizeof(move), "\x1b[%d;%dH", y + 1, x + 1);
+                        out.append(move, n);
+                    }
+                    if (next[i].color != color) {
+                        color = next[i].color;
+                        out += kSgr[color];
+                    }
+                    out += next[i].ch;
+                    cx = x + 1;
+                    cy = y;
+                    shadow[i] = next[i];
+                }
+            }
+        }
+
+        // Sends what diff() produced; returns the bytes written
+        std::size_t flush()
+        {
+            std::size_t n = out.size();
+            if (n) writeAll(out);
+            out.clear();
+            return n;
+        }
+
+        int rows() const { return h; }
+        std::string out;
+
+    private:
+        int w{ 0 }, h{ 0 };
+        std::vector<Cell> next, shadow;
+    };
+}
+
+void runConsole(Game& game, double ticksPerSecond)
+{
+#ifdef _WIN32
+    // Let the Windows console interpret the escape codes
+    HANDLE con = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(con, &mode)) SetConsoleMode(con, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+    // The game's own chatter would scroll the view away: the game runs quiet
+    // and anything else printed meanwhile is dropped
+    game.setQuiet(true);
+    std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+    auto previous = std::signal(SIGINT, onInterrupt);
+
+    using clock = std::chrono::steady_clock;
+    const auto frameTime = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / kConsoleFps));
+
+    SimThread sim(game, ticksPerSecond);
+    ConsoleView view;
+    view.out.reserve(1 << 16);
+    view.out += "\x1b[?25l";        // hide the cursor
+    sim.start();
+
+    const auto start = clock::now();
+    int frames = 0, skipped = 0, lastTick = 0;
+    char status[160];
+    while (!interrupted) {
+        auto t0 = clock::now();
+        // Read before taking the snapshot, so the final one is drawn
+        bool finished = sim.finished();
+        if (sim.snapshots.fresh()) sim.snapshots.acquire();
+        const RenderSnapshot& snap = sim.snapshots.front();
+        if (snap.tick > lastTick + 1) skipped += snap.tick - lastTick - 1;
+        lastTick = std::max(lastTick, snap.tick);
+
+        double elapsed = std::chrono::duration<double>(t0 - start).count();
+        int alive[2] = { 0, 0 };
+        for (const auto& a : snap.agents)
+            if (a.alive && a.role == Role::Warrior) alive[(int)a.team]++;
+        std::snprintf(status, sizeof(status), " TICK %d  %.0f TICKS/S  %.0f FPS  SKIPPED %d  BLUE %d  ORANGE %d%s ",
+            snap.tick, elapsed > 0 ? snap.tick / elapsed : 0.0, elapsed > 0 ? frames / elapsed : 0.0, skipped,
+            alive[0], alive[1], snap.running ? "" : "  GAME OVER");
+
+        view.resize(game.grid);
+        view.compose(game.grid, snap, status);
+        view.diff();
+        view.flush();
+        frames++;
+        if (finished) break;
+
+        // write() blocks while the terminal is behind; when a frame took longer
+        // than its slot, wait that long again so the pty can drain and the
+        // frame rate drops instead of output piling up
+        auto spent = clock::now() - t0;
+        std::this_thread::sleep_until(t0 + std::max<clock::duration>(frameTime, spent * 2));
+    }
+    sim.stop();
+
+    char end[32];
+    int n = std::snprintf(end, sizeof(end), "\x1b[0m\x1b[%d;1H\n\x1b[?25h", view.rows());
+    view.out.assign(end, n);
+    view.flush();
+
+    std::signal(SIGINT, previous);
+    std::cout.rdbuf(coutBuf);
+    std::cout << (interrupted ? "Interrupted" : "Game over") << " after " << lastTick << " ticks, " << frames << " frames drawn\n";
+}
@@ -0,0 +1,254 @@
+﻿// Events.cpp - Event bus ring and dispatch, console / metrics / binary sinks
+// and the binary log reader
+// The console lines are the ones Game::step and CommanderAI used to print.
+
+#include "Events.h"
+#include "Metrics.h"
+#include <cstring>
+#include <ostream>
+
+namespace
+{
+    struct LogHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t recordSize;
+    };
+
+    const char kMagic[8] = { 'A', 'I', 'E', 'V', 'E', 'N', 'T', 'S' };
+    constexpr std::uint32_t kLogVersion = 1;
+
+    void winnerBanner(std::ostream& os, Team t)
+    {
+        os << "\n🏆🏆🏆 " << (t == Team::Blue ? "BLUE" : "ORANGE") << " TEAM WINS! 🏆🏆🏆\n";
+    }
+
+    void printGameOver(std::ostream& os, const GameOverEvent& o)
+    {
+        const bool blueWon = o.winner == Team::Blue;
+        const int winW = blueWon ? o.blueWarriors : o.orangeWarriors, loseW = blueWon ? o.orangeWarriors : o.blueWarriors;
+        const int winHP = blueWon ? o.blueHP : o.orangeHP, loseHP = blueWon ? o.orangeHP : o.blueHP;
+
+        switch (o.reason) {
+        case GameOverReason::Overrun:
+            os << "\n⏱️ Game TIMEOUT! Draw.\n";
+            break;
+
+        case GameOverReason::CommanderDown:
+            winnerBanner(os, o.winner);
+            if (blueWon) os << "Orange Commander eliminated!\n" << "Game over - stopping timer\n";
+            else os << "Blue Commander eliminated!\n";
+            break;
+
+        case GameOverReason::Stalemate:
+            os << "\n⚖️ STALEMATE DETECTED (no changes for 500 ticks) ⚖️\n";
+            if (o.draw) {
+                os << "\n🤝 DRAW! 🤝\n";
+                os << "Both teams equal: " << o.blueWarriors << " warriors, " << o.blueHP << " HP\n";
+                break;
+            }
+            winnerBanner(os, o.winner);
+            if (winW != loseW) os << teamName(o.winner) << " has more warriors (" << winW << " vs " << loseW << ")\n";
+            else os << teamName(o.winner) << " has more total HP (" << winHP << " vs " << loseHP << ")\n";
+            break;
+
+        case GameOverReason::Timeout:
+            os << "\n⏰ ABSOLUTE TIMEOUT (5000 ticks) ⏰\n";
+            if (o.draw) {
+                os << "\n🤝 DRAW! 🤝\n";
+                os << "Timeout: Both teams have " << o.blueWarriors << " warriors\n";
+                break;
+            }
+            winnerBanner(os, o.winner);
+            os << "Timeout: " << teamName(o.winner) << " has more warriors (" << winW << " vs " << loseW << ")\n";
+            break;
+        }
+    }
+}
+
+const char* roleName(Role r)
+{
+    switch (r) {
+    case Role::Commander: return "Commander";
+    case Role::Warrior: return "Warrior";
+    case Role::Medic: return "Medic";
+    case Role::Porter: return "Porter";
+    }
+    return "?";
+}
+
+void EventBus::subscribe(EventSink& sink, std::uint32_t mask)
+{
+    for (auto& s : sinks)
+        if (s.sink == &sink) {
+            s.mask = mask;
+            return;
+        }
+    sinks.push_back({ &sink, mask });
+}
+
+void EventBus::unsubscribe(EventSink& sink)
+{
+    for (std::size_t i = 0; i < sinks.size(); ++i)
+        if (sinks[i].sink == &sink) {
+            sinks.erase(sinks.begin() + i);
+            return;
+        }
+}
+
+bool EventBus::subscribed(const EventSink& sink) const
+{
+    for (auto& s : sinks)
+        if (s.sink == &sink) return true;
+    return false;
+}
+
+void EventBus::dispatch()
+{
+    for (; dispatched < published; ++dispatched) {
+        const GameEvent& e = ring[(std::size_t)(dispatched & (kEventRing - 1))];
+        const std::uint32_t bit = eventBit(e.type);
+        for (auto& s : sinks)
+            if (s.mask & bit) s.sink->onEvent(e);
+    }
+}
+
+const GameEvent* EventBus::at(std::uint64_t seq) const
+{
+    if (seq >= published || published - seq > (std::uint64_t)kEventRing) return nullptr;
+    return &ring[(std::size_t)(seq & (kEventRing - 1))];
+}
+
+void printEvent(std::ostream& os, const GameEvent& e)
+{
+    switch (e.type) {
+    case GameEventType::Hit:
+        os << "💥 " << teamName(e.hit.shooter.team) << " shot " << teamName(e.hit.victim.team) << " "
+           << roleName(e.hit.victim.role) << " (HP:" << e.hit.hp << ")\n";
+        break;
+    case GameEventType::GrenadeThrown:
+        os << "💣 " << teamName(e.grenade.thrower.team) << " threw grenade (dist=" << e.grenade.distance << ")!\n";
+        break;
+    case GameEventType::Explosion:
+        os << "💥 GRENADE exploded at " << e.explosion.x << "," << e.explosion.y << "\n";
+        break;
+    case GameEventType::MedicDispatched:
+        os << "[MEDIC] " << teamName(e.medic.medic.team) << " dispatching medic (warrior HP=" << e.medic.hp << ")\n";
+        break;
+    case GameEventType::Heal:
+        os << "[MEDIC] Healed " << teamName(e.medic.medic.team) << " warrior to HP=" << e.medic.hp << "!\n";
+        break;
+    case GameEventType::Revive:
+        // hp 0: the warrior had used up its revives and is gone for good
+        if (e.medic.hp > 0)
+            os << "[MEDIC] REVIVED " << teamName(e.medic.medic.team) << " warrior from 0 HP to " << e.medic.hp << " HP!\n";
+        else
+            os << "[MEDIC] Could not revive " << teamName(e.medic.medic.team) << " warrior: no revives left\n";
+        break;
+    case GameEventType::Resupply:
+        os << "🔫 Porter resupplied " << teamName(e.resupply.porter.team)
+           << " warrior at tick " << e.tick << " (next at " << e.resupply.nextTick << ")\n";
+        break;
+    case GameEventType::Census:
+        if (e.census.header) {
+            os << "\n=== TICK " << e.tick << " ===\n";
+            os << "Blue: " << e.census.blue << " warriors | Orange: " << e.census.orange << " warriors\n";
+        }
+        else {
+            os << "Blue: " << e.census.blue << " alive | Orange: " << e.census.orange << " alive\n";
+        }
+        break;
+    case GameEventType::NoCombat:
+        os << "⚠️ No combat this cycle\n";
+        break;
+    case GameEventType::GameOver:
+        printGameOver(os, e.over);
+        break;
+    default:
+        break;
+    }
+}
+
+void ConsoleEventSink::onEvent(const GameEvent& e)
+{
+    printEvent(os, e);
+}
+
+void MetricsEventSink::onEvent(const GameEvent& e)
+{
+    switch (e.type) {
+    case GameEventType::Shot: metrics::add(Counter::Shots); break;
+    case GameEventType::Hit: metrics::add(Counter::Hits); break;
+    case GameEventType::GrenadeThrown: metrics::add(Counter::Grenades); break;
+    case GameEventType::Death: metrics::add(Counter::Deaths); break;
+    case GameEventType::Revive: metrics::add(Counter::Revives); break;
+    case GameEventType::Resupply: metrics::add(Counter::Resupplies); break;
+    default: break;
+    }
+}
+
+bool BinaryEventLog::open(const std::string& path, std::string& error)
+{
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "Cannot write " + path;
+        return false;
+    }
+    LogHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kLogVersion;
+    h.recordSize = (std::uint32_t)sizeof(GameEvent);
+    std::fwrite(&h, sizeof(h), 1, file);
+    records = 0;
+    return true;
+}
+
+bool BinaryEventLog::close()
+{
+    if (!file) return true;
+    bool ok = !std::ferror(file);
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+void BinaryEventLog::onEvent(const GameEvent& e)
+{
+    if (!file) return;
+    std::fwrite(&e, sizeof(e), 1, file);
+    records++;
+}
+
+bool replayEventLog(const std::string& path, EventBus& bus, std::string& error)
+{
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        error = "Cannot read " + path;
+        return false;
+    }
+    LogHeader h{};
+    bool ok = std::fread(&h, sizeof(h), 1, f) == 1 && std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0;
+    if (!ok) error = path + ": not an event log";
+    else if (h.version != kLogVersion || h.recordSize != sizeof(GameEvent)) {
+        error = path + ": event log from another version or build";
+        ok = false;
+    }
+
+    GameEvent e;
+    while (ok && std::fread(&e, sizeof(e), 1, f) == 1) {
+        if ((unsigned)e.type >= (unsigned)GameEventType::Count) {
+            error = path + ": corrupt event record";
+            ok = false;
+            break;
+        }
+        bus.publish(e);
+    }
+    if (ok && std::ferror(f)) {
+        error = "Reading " + path + " failed";
+        ok = false;
+    }
+    std::fclose(f);
+    bus.dispatch();
+    return ok;
+}
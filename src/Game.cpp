@@ -6,8 +6,12 @@
 // - Agent visibility and perception
 
 #include "Game.h"
+#include "TaskPool.h"
+#include "Profiler.h"
+#include "Metrics.h"
 
 #include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <iostream>
 #include <queue>
@@ -34,11 +38,6 @@ namespace
         return std::abs(a.x - b.x) + std::abs(a.y - b.y);
     }
 
-    constexpr int FIRE_RANGE = 6;      // Gun range: 6 tiles
-    constexpr int GRENADE_RANGE = 10;  // Grenade range: longer than guns for suppression
-    constexpr int FIRE_DAMAGE = 20;    // Bullet damage: 20 (5 shots to kill)
-    constexpr int GRENADE_DAMAGE = 15; // Grenade damage: 15 (less than bullets, for suppression)
-
     // שכנים 4 כיוונים
     std::vector<IVec2> neighbors4(const Grid& g, IVec2 p)
     {
@@ -55,6 +54,30 @@ namespace
         return out;
     }
 
+    Role roleOf(const TeamState& ts, const Agent& a)
+    {
+        if (&a == &ts.commander) return Role::Commander;
+        if (&a == &ts.medic) return Role::Medic;
+        if (&a == &ts.porter) return Role::Porter;
+        return Role::Warrior;
+    }
+
+    EventUnit unitOf(const TeamState& ts, const Agent& a)
+    {
+        return eventUnit(ts.team, roleOf(ts, a), a.pos);
+    }
+
+    // Level of detail: nothing beyond grenade range can be engaged, so
+    // warriors with no enemy within lodDistance skip their LOS scan
+    bool outOfReach(IVec2 p, const std::vector<IVec2>& spots)
+    {
+        if (tunables().lodDistance <= 0 || !tunables().lodSkipScans) return false;
+        const int reach = std::max(tunables().lodDistance, tunables().grenadeRange);
+        for (auto e : spots)
+            if (manhattan(p, e) <= reach) return false;
+        return true;
+    }
+
     int key(IVec2 p, int w) { return p.y * w + p.x; }
 
     std::vector<IVec2> reconstructPath(
@@ -179,50 +202,58 @@ namespace
     }
 }
 
-Game::Game(const Grid& g, const GameConfig& config)
+Game::Game(const Grid& g, const Scenario& s)
     : grid(g)
-    , blue(Team::Blue, g,
-        IVec2{ 2, 2 },
-        IVec2{ 3, 3 }, IVec2{ 3, 5 },
-        IVec2{ 2, 4 }, IVec2{ 2, 6 })
-    , orange(Team::Orange, g,
-        IVec2{ g.w - 3, g.h - 3 },
-        IVec2{ g.w - 4, g.h - 4 },
-        IVec2{ g.w - 4, g.h - 6 },
-        IVec2{ g.w - 3, g.h - 4 },
-        IVec2{ g.w - 3, g.h - 6 })
+    , blue(Team::Blue, s)
+    , orange(Team::Orange, s)
+    , console(std::cout)
 {
+    events.subscribe(console, ConsoleEventSink::kMask);
+    events.subscribe(eventMetrics);
+
+    // Every unit asks for at most one path per tick, a far warrior keeps
+    // its route between re-plans, and the risk layers start with their chunks
+    const std::size_t pathCells = std::min<std::size_t>((std::size_t)g.w * g.h, kPathReserveCells);
+    const int riskChunks = std::min(((g.w + kChunkSize - 1) >> kChunkShift) * ((g.h + kChunkSize - 1) >> kChunkShift),
+                                    kRiskReserveChunks);
+    for (auto* ts : { &blue, &orange }) {
+        ts->ai.paths.reserve(ts->warriors.size() + 3, pathCells);
+        ts->ai.routes.resize(ts->warriors.size());
+        for (auto& r : ts->ai.routes) r.path.reserve(pathCells);
+        ts->ai.risk.reserve(riskChunks);
+        ts->ai.riskNext.reserve(riskChunks);
+    }
+
     // Open log file
     g_logFile.open("game_debug.log");
     if (g_logFile.is_open()) {
         g_logFile << "=== GAME DEBUG LOG ===" << std::endl;
-        g_logFile << "Configuration: Blue(+" << config.blueExtraHP << " HP, +" 
-                  << config.blueExtraAmmo << " Ammo, +" << config.blueExtraGrenades 
-                  << " Grenades)" << std::endl;
-        g_logFile << "Configuration: Orange(+" << config.orangeExtraHP << " HP, +" 
-                  << config.orangeExtraAmmo << " Ammo, +" << config.orangeExtraGrenades 
-                  << " Grenades)" << std::endl;
+        g_logFile << "Scenario: " << (s.name.empty() ? "(unnamed)" : s.name) << std::endl;
+        for (auto* ts : { &blue, &orange }) {
+            int hp = 0, ammo = 0, grenades = 0;
+            for (auto& w : ts->warriors) {
+                hp += w.hp;
+                ammo += w.ammo;
+                grenades += w.grenades;
+            }
+            g_logFile << "Configuration: " << teamName(ts->team) << " " << ts->warriors.size()
+                      << " warriors (" << hp << " HP, " << ammo << " Ammo, " << grenades
+                      << " Grenades in total)" << std::endl;
+        }
         g_logFile << std::endl;
     }
-    
-    // Apply configuration to Blue team
-    for (auto& w : blue.warriors) {
-        w.hp = kMaxHP + config.blueExtraHP;
-        w.ammo = 20 + config.blueExtraAmmo;
-        w.grenades = 2 + config.blueExtraGrenades;
-    }
-    
-    // Apply configuration to Orange team
-    for (auto& w : orange.warriors) {
-        w.hp = kMaxHP + config.orangeExtraHP;
-        w.ammo = 20 + config.orangeExtraAmmo;
-        w.grenades = 2 + config.orangeExtraGrenades;
-    }
 }
 
-std::vector<IVec2> Game::enemySpots(Team t) const
+void Game::setQuiet(bool quiet)
 {
-    std::vector<IVec2> v;
+    if (quiet) events.unsubscribe(console);
+    else events.subscribe(console, ConsoleEventSink::kMask);
+    blue.ai.quiet = orange.ai.quiet = quiet;
+}
+
+void Game::enemySpots(Team t, std::vector<IVec2>& v) const
+{
+    v.clear();
     auto const& en = (t == Team::Blue ? orange : blue);
 
     if (en.commander.alive) v.push_back(en.commander.pos);
@@ -230,8 +261,6 @@ std::vector<IVec2> Game::enemySpots(Team t) const
     if (en.porter.alive)    v.push_back(en.porter.pos);
     for (auto const& w : en.warriors)
         if (w.alive || w.incapacitated) v.push_back(w.pos); // include incapacitated
-
-    return v;
 }
 
 Agent* Game::findAgentAt(Team t, IVec2 p)
@@ -249,23 +278,33 @@ Agent* Game::findAgentAt(Team t, IVec2 p)
 
 void Game::step()
 {
+    PROFILE_ZONE("Game::step");
+    const std::uint64_t allocationsBefore = metrics::allocations();
+    PROFILE_BEGIN(bullets, "bullets.update");
     bullets.update(grid);
+    PROFILE_END(bullets);
 
     // Per-tick granular position logging
+    PROFILE_BEGIN(positions, "logPositionsTick");
     logPositionsTick();
+    PROFILE_END(positions);
 
-    if (tick % 500 == 0) {  // Print every 500 ticks
-        std::cout << "\n=== TICK " << tick << " ===\n";
-        
+    auto census = [&](bool header) {
+        GameEvent e = GameEvent::make(GameEventType::Census, tick);
         int blueAlive = 0, orangeAlive = 0;
         for (auto& w : blue.warriors) if (w.alive) blueAlive++;
         for (auto& w : orange.warriors) if (w.alive) orangeAlive++;
-        
-        std::cout << "Blue: " << blueAlive << " warriors | Orange: " << orangeAlive << " warriors\n";
-    }
+        e.census = { (std::int16_t)blueAlive, (std::int16_t)orangeAlive, header };
+        events.publish(e);
+    };
+    if (tick % 500 == 0) census(true);  // Banner every 500 ticks
 
     if (tick > 5000) {
-        std::cout << "\n⏱️ Game TIMEOUT! Draw.\n";
+        GameEvent e = GameEvent::make(GameEventType::GameOver, tick);
+        e.over.reason = GameOverReason::Overrun;
+        e.over.draw = true;
+        events.publish(e);
+        events.dispatch();
         running = false;
         return;
     }
@@ -274,142 +313,171 @@ void Game::step()
     //moveWarriors(grid, blue, orange);
     //moveWarriors(grid, orange, blue);
 
-    auto spotsForBlue = enemySpots(Team::Blue);
-    auto spotsForOrange = enemySpots(Team::Orange);
-    CommanderAI::step(grid, blue.commander, blue.warriors,
-        blue.medic, blue.porter, spotsForBlue, tick);
-
-    CommanderAI::step(grid, orange.commander, orange.warriors,
-        orange.medic, orange.porter, spotsForOrange, tick);
+    // Read-old/write-new: both commanders plan against the enemy positions
+    // captured here and only write their own team, so they run concurrently.
+    // Their events and console output are committed afterwards in a fixed
+    // team order.
+    PROFILE_BEGIN(spots, "enemySpots");
+    enemySpots(Team::Blue, spotsForBlue);
+    enemySpots(Team::Orange, spotsForOrange);
+    PROFILE_END(spots);
+    TeamState* teams[2] = { &blue, &orange };
+    const std::vector<IVec2>* teamSpots[2] = { &spotsForBlue, &spotsForOrange };
+
+    TaskPool::shared().parallelFor(2, [&](int i) {
+        PROFILE_ZONE("CommanderAI::step");
+        TeamState& ts = *teams[i];
+        CommanderAI::step(grid, ts.commander, ts.warriors,
+            ts.medic, ts.porter, *teamSpots[i], tick, &ts.ai);
+    });
+
+    for (TeamState* ts : teams) {
+        for (const GameEvent& e : ts->ai.events) events.publish(e);
+        ts->ai.events.clear();
+        events.dispatch();
+        if (ts->ai.log.tellp() > 0) std::cout << ts->ai.log.rdbuf();
+        ts->ai.log.str("");
+    }
 
     //---------------------------------------------
  //    GRENADE UPDATE + EXPLOSION DAMAGE
  //---------------------------------------------
+    PROFILE_BEGIN(grenadeZone, "grenades");
     grenades.updateAndExplode([&](float gx, float gy, float radius)
         {
-            auto hit = [&](Agent& A)
+            auto hit = [&](TeamState& ts, Agent& A)
                 {
                     if (!A.alive || A.hp <= 0) return;  // Don't damage dead agents
 
                     float dx = A.pos.x - gx;
                     float dy = A.pos.y - gy;
-                    if (dx * dx + dy * dy <= radius * radius)
-                        A.takeDamage(GRENADE_DAMAGE);
+                    if (dx * dx + dy * dy <= radius * radius) {
+                        A.takeDamage(tunables().grenadeDamage);
+                        ts.ai.sched.post(AgentEvent::DamageTaken);
+                        if (A.hp == 0) {
+                            GameEvent e = GameEvent::make(GameEventType::Death, tick);
+                            e.death = { unitOf(ts, A), !A.alive };
+                            events.publish(e);
+                        }
+                    }
                 };
 
+            GameEvent e = GameEvent::make(GameEventType::Explosion, tick);
+            e.explosion = { gx, gy, radius };
+            events.publish(e);
+
             // פגיעה בכחולים
-            hit(blue.commander);
-            hit(blue.medic);
-            hit(blue.porter);
-            for (auto& w : blue.warriors) hit(w);
+            hit(blue, blue.commander);
+            hit(blue, blue.medic);
+            hit(blue, blue.porter);
+            for (auto& w : blue.warriors) hit(blue, w);
 
             // פגיעה בכתומים
-            hit(orange.commander);
-            hit(orange.medic);
-            hit(orange.porter);
-            for (auto& w : orange.warriors) hit(w);
-
-            std::cout << "💥 GRENADE exploded at " << gx << "," << gy << "\n";
+            hit(orange, orange.commander);
+            hit(orange, orange.medic);
+            hit(orange, orange.porter);
+            for (auto& w : orange.warriors) hit(orange, w);
         });
+    PROFILE_END(grenadeZone);
 
 
 
-    // ----------------- Blue team combat -----------------
-    int blueShotsThisTurn = 0;
-    for (auto& w : blue.warriors)
-    {
-        if ((!w.alive && !w.incapacitated) || w.incapacitated) continue; // skip incapacitated for shooting
+    auto fired = [&](const TeamState& ts, const Warrior& w, IVec2 target) {
+        GameEvent e = GameEvent::make(GameEventType::Shot, tick);
+        e.shot = { unitOf(ts, w), (std::int16_t)target.x, (std::int16_t)target.y };
+        events.publish(e);
+    };
+    auto threw = [&](const TeamState& ts, const Warrior& w, IVec2 target, int dist) {
+        GameEvent e = GameEvent::make(GameEventType::GrenadeThrown, tick);
+        e.grenade = { unitOf(ts, w), (std::int16_t)target.x, (std::int16_t)target.y, (std::int16_t)dist };
+        events.publish(e);
+    };
 
-        Perception per = w.look(grid, spotsForBlue);
-        
-        if (per.seesEnemy)
+    // Both teams fire at the state the tick's combat began with: a warrior
+    // downed by a shot this tick still fires back, and every shot at a unit
+    // standing at the start lands. Damage is applied afterwards, Blue's
+    // shots first, which only orders the events.
+    pendingHits.clear();
+    auto fire = [&](TeamState& ts, TeamState& enemy, const std::vector<IVec2>& spots) {
+        int shots = 0;
+        for (auto& w : ts.warriors)
         {
-            IVec2 targetPos = *per.enemyPos;
-            int   dist = manhattan(w.pos, targetPos);
+            if ((!w.alive && !w.incapacitated) || w.incapacitated) continue; // skip incapacitated for shooting
+            if (outOfReach(w.pos, spots)) continue;
+
+            Perception per = w.look(grid, spots);
 
-            // Priority 1: Shoot if in gun range and have ammo
-            if (dist <= FIRE_RANGE && w.ammo > 0)
+            if (per.seesEnemy)
             {
-                w.ammo--;
-                bullets.addBullet(
-                    w.pos.x + 0.5f, w.pos.y + 0.5f,
-                    targetPos.x + 0.5f, targetPos.y + 0.5f);
+                ts.ai.sched.post(AgentEvent::EnemySighted);
+                IVec2 targetPos = *per.enemyPos;
+                int   dist = manhattan(w.pos, targetPos);
 
-                Agent* victim = findAgentAt(Team::Orange, targetPos);
-                if (victim && victim->hp > 0)  // Don't shoot corpses!
+                // Priority 1: Shoot if in gun range and have ammo
+                if (dist <= tunables().gunRange && w.ammo > 0)
                 {
-                    victim->takeDamage(FIRE_DAMAGE);
-                    blueShotsThisTurn++;
-                    std::cout << "💥 Blue shot Orange " << victim->role << " (HP:" << victim->hp << ")\n";
+                    w.ammo--;
+                    if (w.ammo < tunables().lowAmmo) ts.ai.sched.post(AgentEvent::AmmoDepleted);
+                    bullets.addBullet(
+                        w.pos.x + 0.5f, w.pos.y + 0.5f,
+                        targetPos.x + 0.5f, targetPos.y + 0.5f);
+                    fired(ts, w, targetPos);
+
+                    Agent* victim = findAgentAt(enemy.team, targetPos);
+                    if (victim && victim->hp > 0)  // Don't shoot corpses!
+                    {
+                        pendingHits.push_back({ &ts, &w, &enemy, victim });
+                        shots++;
+                    }
+                }
+                // Priority 2: Grenade if out of gun range but within grenade range
+                else if (dist > tunables().gunRange && dist <= tunables().grenadeRange && w.grenades > 0)
+                {
+                    w.grenades--;
+                    if (w.grenades == 0) ts.ai.sched.post(AgentEvent::AmmoDepleted);
+                    grenades.addGrenade(
+                        w.pos.x + 0.5f, w.pos.y + 0.5f,
+                        targetPos.x + 0.5f, targetPos.y + 0.5f);
+                    shots++;
+                    threw(ts, w, targetPos, dist);
                 }
-            }
-            // Priority 2: Grenade if out of gun range but within grenade range
-            else if (dist > FIRE_RANGE && dist <= GRENADE_RANGE && w.grenades > 0)
-            {
-                w.grenades--;
-                grenades.addGrenade(
-                    w.pos.x + 0.5f, w.pos.y + 0.5f,
-                    targetPos.x + 0.5f, targetPos.y + 0.5f);
-                blueShotsThisTurn++;
-                std::cout << "💣 Blue threw grenade (dist=" << dist << ")!\n";
             }
         }
-    }
-
-    // ----------------- Orange team combat -----------------
-    int orangeShotsThisTurn = 0;
-    for (auto& w : orange.warriors)
-    {
-        if ((!w.alive && !w.incapacitated) || w.incapacitated) continue; // skip incapacitated for shooting
+        return shots;
+    };
 
-        Perception per = w.look(grid, spotsForOrange);
-        
-        if (per.seesEnemy)
-        {
-            IVec2 targetPos = *per.enemyPos;
-            int   dist = manhattan(w.pos, targetPos);
+    PROFILE_BEGIN(blueCombat, "combat blue");
+    int blueShotsThisTurn = fire(blue, orange, spotsForBlue);
+    PROFILE_END(blueCombat);
 
-            // Priority 1: Shoot if in gun range and have ammo
-            if (dist <= FIRE_RANGE && w.ammo > 0)
-            {
-                w.ammo--;
-                bullets.addBullet(
-                    w.pos.x + 0.5f, w.pos.y + 0.5f,
-                    targetPos.x + 0.5f, targetPos.y + 0.5f);
+    PROFILE_BEGIN(orangeCombat, "combat orange");
+    int orangeShotsThisTurn = fire(orange, blue, spotsForOrange);
+    PROFILE_END(orangeCombat);
 
-                Agent* victim = findAgentAt(Team::Blue, targetPos);
-                if (victim && victim->hp > 0)  // Don't shoot corpses!
-                {
-                    victim->takeDamage(FIRE_DAMAGE);
-                    orangeShotsThisTurn++;
-                    std::cout << "💥 Orange shot Blue " << victim->role << " (HP:" << victim->hp << ")\n";
-                }
-            }
-            // Priority 2: Grenade if out of gun range but within grenade range
-            else if (dist > FIRE_RANGE && dist <= GRENADE_RANGE && w.grenades > 0)
-            {
-                w.grenades--;
-                grenades.addGrenade(
-                    w.pos.x + 0.5f, w.pos.y + 0.5f,
-                    targetPos.x + 0.5f, targetPos.y + 0.5f);
-                orangeShotsThisTurn++;
-                std::cout << "💣 Orange threw grenade (dist=" << dist << ")!\n";
-            }
+    // Commit: every landed shot deals its damage
+    for (const PendingHit& h : pendingHits)
+    {
+        Agent& victim = *h.victim;
+        const bool standing = victim.hp > 0;
+        victim.takeDamage(tunables().gunDamage);
+        h.victimTeam->ai.sched.post(AgentEvent::DamageTaken);
+
+        GameEvent e = GameEvent::make(GameEventType::Hit, tick);
+        e.hit = { unitOf(*h.shooterTeam, *h.shooter), unitOf(*h.victimTeam, victim), (std::int16_t)victim.hp };
+        events.publish(e);
+        if (standing && victim.hp == 0) {
+            e = GameEvent::make(GameEventType::Death, tick);
+            e.death = { unitOf(*h.victimTeam, victim), !victim.alive };
+            events.publish(e);
         }
     }
     
     if (tick % 100 == 0 && (blueShotsThisTurn == 0 && orangeShotsThisTurn == 0)) {
-        std::cout << "⚠️ No combat this cycle\n";
+        events.publish(GameEvent::make(GameEventType::NoCombat, tick));
     }
     // NOTE: Commanders CANNOT attack per project requirements
     // They can only issue orders and move to safer positions
-    if (tick % 50 == 0) {  // Every 50 ticks
-        int blueAlive = 0, orangeAlive = 0;
-        for (auto& w : blue.warriors) if (w.alive) blueAlive++;
-        for (auto& w : orange.warriors) if (w.alive) orangeAlive++;
-
-        std::cout << "Blue: " << blueAlive << " alive | Orange: " << orangeAlive << " alive\n";
-    }
+    if (tick % 50 == 0) census(false);  // Every 50 ticks
 
     // Count warriors only (not commander)
     int blueWarriors = 0, orangeWarriors = 0;
@@ -421,10 +489,6 @@ void Game::step()
     // Check win conditions:
     // 1. Commander death = immediate loss
     // 2. Stalemate detection: if nothing changes for 500 ticks
-    static int lastBlueWarriors = blueWarriors;
-    static int lastOrangeWarriors = orangeWarriors;
-    static int lastBlueHP = 0, lastOrangeHP = 0;
-    static int stalemateTicks = 0;
     
     // Calculate total HP for both teams
     int currentBlueHP = 0, currentOrangeHP = 0;
@@ -444,72 +508,64 @@ void Game::step()
     }
     
     // Check win conditions
+    GameEvent over = GameEvent::make(GameEventType::GameOver, tick);
+    GameOverEvent& result = over.over;
+    result.blueWarriors = (std::int16_t)blueWarriors;
+    result.orangeWarriors = (std::int16_t)orangeWarriors;
+    result.blueHP = currentBlueHP;
+    result.orangeHP = currentOrangeHP;
+    bool ended = true;
     if (!blue.commander.alive) {
-        std::cout << "\n🏆🏆🏆 ORANGE TEAM WINS! 🏆🏆🏆\n";
-        std::cout << "Blue Commander eliminated!\n";
-        running = false;
+        result.reason = GameOverReason::CommanderDown;
+        result.winner = Team::Orange;
     }
     else if (!orange.commander.alive) {
-        std::cout << "\n🏆🏆🏆 BLUE TEAM WINS! 🏆🏆🏆\n";
-        std::cout << "Orange Commander eliminated!\n";
-        std::cout << "Game over - stopping timer\n";
-        running = false;
+        result.reason = GameOverReason::CommanderDown;
+        result.winner = Team::Blue;
     }
     else if (stalemateTicks >= 500) {
-        // Stalemate: count surviving warriors and HP
-        std::cout << "\n⚖️ STALEMATE DETECTED (no changes for 500 ticks) ⚖️\n";
-        if (blueWarriors > orangeWarriors) {
-            std::cout << "\n🏆🏆🏆 BLUE TEAM WINS! 🏆🏆🏆\n";
-            std::cout << "Blue has more warriors (" << blueWarriors << " vs " << orangeWarriors << ")\n";
-        }
-        else if (orangeWarriors > blueWarriors) {
-            std::cout << "\n🏆🏆🏆 ORANGE TEAM WINS! 🏆🏆🏆\n";
-            std::cout << "Orange has more warriors (" << orangeWarriors << " vs " << blueWarriors << ")\n";
-        }
-        else if (currentBlueHP > currentOrangeHP) {
-            std::cout << "\n🏆🏆🏆 BLUE TEAM WINS! 🏆🏆🏆\n";
-            std::cout << "Blue has more total HP (" << currentBlueHP << " vs " << currentOrangeHP << ")\n";
-        }
-        else if (currentOrangeHP > currentBlueHP) {
-            std::cout << "\n🏆🏆🏆 ORANGE TEAM WINS! 🏆🏆🏆\n";
-            std::cout << "Orange has more total HP (" << currentOrangeHP << " vs " << currentBlueHP << ")\n";
-        }
-        else {
-            std::cout << "\n🤝 DRAW! 🤝\n";
-            std::cout << "Both teams equal: " << blueWarriors << " warriors, " << currentBlueHP << " HP\n";
-        }
-        running = false;
+        // Stalemate: surviving warriors decide, then their total HP
+        result.reason = GameOverReason::Stalemate;
+        if (blueWarriors != orangeWarriors) result.winner = blueWarriors > orangeWarriors ? Team::Blue : Team::Orange;
+        else if (currentBlueHP != currentOrangeHP) result.winner = currentBlueHP > currentOrangeHP ? Team::Blue : Team::Orange;
+        else result.draw = true;
     }
     else if (tick >= 5000) {
-        // Absolute timeout failsafe
-        std::cout << "\n⏰ ABSOLUTE TIMEOUT (5000 ticks) ⏰\n";
-        if (blueWarriors > orangeWarriors) {
-            std::cout << "\n🏆🏆🏆 BLUE TEAM WINS! 🏆🏆🏆\n";
-            std::cout << "Timeout: Blue has more warriors (" << blueWarriors << " vs " << orangeWarriors << ")\n";
-        }
-        else if (orangeWarriors > blueWarriors) {
-            std::cout << "\n🏆🏆🏆 ORANGE TEAM WINS! 🏆🏆🏆\n";
-            std::cout << "Timeout: Orange has more warriors (" << orangeWarriors << " vs " << blueWarriors << ")\n";
-        }
-        else {
-            std::cout << "\n🤝 DRAW! 🤝\n";
-            std::cout << "Timeout: Both teams have " << blueWarriors << " warriors\n";
-        }
+        // Absolute timeout failsafe: surviving warriors decide
+        result.reason = GameOverReason::Timeout;
+        if (blueWarriors != orangeWarriors) result.winner = blueWarriors > orangeWarriors ? Team::Blue : Team::Orange;
+        else result.draw = true;
+    }
+    else ended = false;
+    if (ended) {
+        events.publish(over);
         running = false;
     }
+    events.dispatch();
 
     // Log detailed agent states every 100 ticks
     if (tick % 100 == 0) {
         logDetailedState();
     }
 
+    // Whatever the AI put on its arenas is dead now
+    blue.ai.arena.reset();
+    orange.ai.arena.reset();
+
+    metrics::add(Counter::Ticks);
+    metrics::set(Gauge::BulletsAlive, (std::int64_t)bullets.bullets.size());
+    metrics::record(Histogram::TickAllocations, metrics::allocations() - allocationsBefore);
     tick++;
 }
 
 void Game::logDetailedState()
 {
-    std::ofstream logFile("game_log.txt", std::ios::app);
-    if (!logFile.is_open()) return;
+    // Kept open between calls and flushed after each, so the file reads the
+    // same as when it was reopened every time
+    if (!detailLog.is_open()) detailLog.open("game_log.txt", std::ios::app);
+    if (!detailLog.is_open()) return;
+    std::ostream& logFile = detailLog;
+    const auto start = detailLog.tellp();
 
     logFile << "\n========== TICK " << tick << " ==========" << '\n';
     
@@ -525,28 +581,66 @@ void Game::logDetailedState()
                     << " alive=" << w.alive << " inc=" << w.incapacitated
                     << " revives=" << w.reviveCount << " resupplies=" << w.resupplyCount << '\n';
         }
+        const PathServiceStats& ps = ts.ai.paths.stats();
+        logFile << " Paths: requests=" << ps.requests << " solved=" << ps.solved
+                << " dedupRate=" << ps.dedupRate()
+                << " hpa=" << ps.hierarchical << " jps=" << ps.jumpPoint
+                << " queue=" << ps.lastQueueDepth << " maxQueue=" << ps.maxQueueDepth << '\n';
+        logFile << " Risk chunks awake: " << ts.ai.risk.allocatedChunks() << " of " << ts.ai.risk.chunkCount() << '\n';
+        logFile << " Path solve time (us):";
+        for (size_t b = 0; b < ps.solveMicros.size(); ++b)
+            if (ps.solveMicros[b])
+                logFile << " <" << (2u << b) << ":" << ps.solveMicros[b];
+        logFile << '\n';
     };
     logTeam(blue);
     logTeam(orange);
     
-    logFile.close();
+    metrics::add(Counter::LogBytes, (std::uint64_t)(detailLog.tellp() - start));
+    detailLog.flush();
 }
 
 void Game::logPositionsTick()
 {
     if (!g_logFile.is_open()) return;
-    g_logFile << "T" << tick << ":";
+    // One line per tick, built in a buffer that keeps its capacity and
+    // written in one go
+    std::string& s = logLine;
+    s.clear();
+    auto num = [&](int v) {
+        char buf[16];
+        s.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr);
+    };
+    auto pos = [&](const char* tag, IVec2 p) {
+        s += tag;
+        s += '(';
+        num(p.x);
+        s += ',';
+        num(p.y);
+        s += ')';
+    };
+    s += 'T';
+    num(tick);
+    s += ':';
     auto logTeam = [&](const TeamState& ts){
-        g_logFile << (ts.team == Team::Blue ? " B" : " O") << "[C(" << ts.commander.pos.x << "," << ts.commander.pos.y << ")";
-        g_logFile << ";M(" << ts.medic.pos.x << "," << ts.medic.pos.y << ")";
-        g_logFile << ";P(" << ts.porter.pos.x << "," << ts.porter.pos.y << ")";
+        s += ts.team == Team::Blue ? " B[" : " O[";
+        pos("C", ts.commander.pos);
+        pos(";M", ts.medic.pos);
+        pos(";P", ts.porter.pos);
         for (size_t i=0;i<ts.warriors.size();++i){
             const auto& w = ts.warriors[i];
-            g_logFile << ";W" << i << "(" << w.pos.x << "," << w.pos.y << ")" << "hp=" << w.hp << (w.incapacitated?"*":"");
+            s += ";W";
+            num((int)i);
+            pos("", w.pos);
+            s += "hp=";
+            num(w.hp);
+            if (w.incapacitated) s += '*';
         }
-        g_logFile << "]";
+        s += ']';
     };
     logTeam(blue);
     logTeam(orange);
-    g_logFile << '\n';
+    s += '\n';
+    g_logFile.write(s.data(), s.size());
+    metrics::add(Counter::LogBytes, s.size());
 }
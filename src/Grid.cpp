@@ -1,10 +1,34 @@
 #include "Grid.h"
-#include <fstream>
+#include "HPAStar.h"
+#include "Landmarks.h"
+#include "JPS.h"
+#include "Risk.h"
+#include "MapFile.h"
+#include <iostream>
 #include <vector>
+
+void Grid::buildDerived(Grid& g, const std::string& landmarkCache){
+    if(g.orangeAmmo==IVec2{0,0}) g.orangeAmmo={g.w-2,g.h-2};
+    if(g.orangeMed==IVec2{0,0}) g.orangeMed={g.w-2,g.h-3};
+    if(g.cover.empty() && g.w*g.h<=kCoverMaxCells) g.cover=buildCoverMap(g);
+    if(!g.hpa && g.w*g.h>=kHpaMinMapCells) g.hpa=buildHpaLayout(g);
+    if(!g.jpsRuns && g.w*g.h<=kJpsMaxCells && g.h<0xFFFF) g.jpsRuns=buildJpsRuns(g);
+    if(!g.landmarks && g.w*g.h<=kLandmarkMaxCells){
+        bool cache=kLandmarkDiskCache && !landmarkCache.empty();
+        if(cache) g.landmarks=loadLandmarks(g,landmarkCache);
+        if(!g.landmarks){
+            g.landmarks=buildLandmarks(g);
+            if(cache) saveLandmarks(g,*g.landmarks,landmarkCache);
+        }
+    }
+}
+
 Grid Grid::loadFromTxt(const std::string& path){
-    Grid g; std::ifstream in(path); std::vector<std::string> lines; std::string s;
-    if(!in){
-        lines = {
+    Grid g;
+    bool fromFile=readAsciiMap(path,g);
+    if(!fromFile){
+        g=Grid();
+        std::vector<std::string> lines = {
             "................................................",
             "................................................",
             "....######.............TTTTT....................",
@@ -15,19 +39,31 @@ Grid Grid::loadFromTxt(const std::string& path){
             "..............................................a.m",
             "................................................"
         };
-    }else while(std::getline(in,s)) if(!s.empty()) lines.push_back(s);
-    g.h=(int)lines.size(); g.w=(int)(lines.empty()?0:lines[0].size());
-    g.cells.assign(g.w*g.h, Tile::Open);
-    for(int y=0;y<g.h;++y) for(int x=0;x<g.w;++x){
-        char c=lines[y][x]; Tile t=Tile::Open;
-        switch(c){
-            case '#': t=Tile::Rock; break; case 'T': t=Tile::Tree; break;
-            case '~': t=Tile::Water; break; case 'A': t=Tile::DepotAmmo; g.blueAmmo={x,y}; break;
-            case 'M': t=Tile::DepotMed; g.blueMed={x,y}; break; case 'a': t=Tile::DepotAmmo; g.orangeAmmo={x,y}; break;
-            case 'm': t=Tile::DepotMed; g.orangeMed={x,y}; break; default: t=Tile::Open; break; }
-        g.cells[y*g.w+x]=t;
+        g.h=(int)lines.size(); g.w=(int)lines[0].size();
+        g.cells.assign(g.w*g.h, Tile::Open);
+        for(int y=0;y<g.h;++y) for(int x=0;x<g.w;++x){
+            char c=lines[y][x]; Tile t=Tile::Open;
+            switch(c){
+                case '#': t=Tile::Rock; break; case 'T': t=Tile::Tree; break;
+                case '~': t=Tile::Water; break; case 'A': t=Tile::DepotAmmo; g.blueAmmo={x,y}; break;
+                case 'M': t=Tile::DepotMed; g.blueMed={x,y}; break; case 'a': t=Tile::DepotAmmo; g.orangeAmmo={x,y}; break;
+                case 'm': t=Tile::DepotMed; g.orangeMed={x,y}; break; default: t=Tile::Open; break; }
+            g.cells[y*g.w+x]=t;
+        }
     }
-    if(g.orangeAmmo==IVec2{0,0}) g.orangeAmmo={g.w-2,g.h-2};
-    if(g.orangeMed==IVec2{0,0}) g.orangeMed={g.w-2,g.h-3};
+    buildDerived(g, fromFile ? path+".landmarks" : std::string());
+    return g;
+}
+
+Grid Grid::load(const std::string& path){
+    const std::string ext=".aimap";
+    if(path.size()<ext.size() || path.compare(path.size()-ext.size(),ext.size(),ext)!=0)
+        return loadFromTxt(path);
+    Grid g;
+    if(!readAimap(path,g)){
+        std::cerr<<"Cannot read map "<<path<<", using the built-in map\n";
+        return loadFromTxt(std::string());
+    }
+    buildDerived(g, std::string());
     return g;
 }
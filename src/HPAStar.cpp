@@ -0,0 +1,298 @@
+// HPAStar.cpp - Hierarchical pathfinding for large maps
+// Abstract graph of cluster entrances, per-team intra-cluster costs that
+// are refreshed only where risk changed, and local path refinement.
+
+#include "HPAStar.h"
+#include "AStar.h"
+#include "Landmarks.h"
+#include "RadixHeap.h"
+#include "Metrics.h"
+#include <queue>
+#include <limits>
+#include <unordered_map>
+#include <cmath>
+
+namespace
+{
+    constexpr float kInf = std::numeric_limits<float>::infinity();
+
+    // Dijkstra inside one cluster. Forward: dist = cost of walking from src to
+    // each cell. Reverse: dist = cost of walking from each cell to src.
+    // Entering a cell q costs 1 + alpha * risk(q).
+    void clusterDijkstra(const Grid& g, IVec2 lo, IVec2 hi, IVec2 src,
+                         const RiskMap& risk, float alpha, bool reverse,
+                         std::vector<float>& dist)
+    {
+        int rw = hi.x - lo.x + 1, rh = hi.y - lo.y + 1;
+        auto lidx = [&](IVec2 p) { return (p.y - lo.y) * rw + (p.x - lo.x); };
+
+        // Searched in integer cost units on the shared radix heap
+        const std::uint32_t kUnreached = std::numeric_limits<std::uint32_t>::max();
+        std::vector<std::uint32_t> d(rw * rh, kUnreached);
+        RadixHeap<int> open;
+
+        d[lidx(src)] = 0;
+        open.push(0, lidx(src));
+
+        static const int dx[4] = { 1, -1, 0, 0 };
+        static const int dy[4] = { 0, 0, 1, -1 };
+        while (!open.empty()) {
+            std::uint32_t cd;
+            int ci = open.pop(&cd);
+            if (cd > d[ci]) continue;
+
+            IVec2 p{ lo.x + ci % rw, lo.y + ci / rw };
+            std::uint32_t stepFrom = quantCost(1.0f + alpha * riskAt(risk, g, p));
+            for (int i = 0; i < 4; ++i) {
+                IVec2 q{ p.x + dx[i], p.y + dy[i] };
+                if (q.x < lo.x || q.y < lo.y || q.x > hi.x || q.y > hi.y || !g.passable(q)) continue;
+                std::uint32_t nd = cd + (reverse ? stepFrom : quantCost(1.0f + alpha * riskAt(risk, g, q)));
+                int qi = lidx(q);
+                if (nd < d[qi]) {
+                    d[qi] = nd;
+                    open.push(nd, qi);
+                }
+            }
+        }
+
+        dist.resize(rw * rh);
+        for (int i = 0; i < rw * rh; ++i)
+            dist[i] = d[i] == kUnreached ? kInf : (float)d[i] / (float)kCostScale;
+    }
+
+    void refreshCluster(const Grid& g, const HpaLayout& L, int c,
+                        const RiskMap& risk, float alpha, std::vector<float>& cost)
+    {
+        IVec2 lo, hi;
+        L.clusterRect(g, c, lo, hi);
+        int rw = hi.x - lo.x + 1;
+        const auto& ns = L.clusterNodes[c];
+        int k = (int)ns.size();
+        std::vector<float> dist;
+        for (int i = 0; i < k; ++i) {
+            clusterDijkstra(g, lo, hi, L.nodes[ns[i]], risk, alpha, false, dist);
+            for (int j = 0; j < k; ++j) {
+                IVec2 q = L.nodes[ns[j]];
+                cost[L.clusterSlot[c] + i * k + j] = dist[(q.y - lo.y) * rw + (q.x - lo.x)];
+            }
+        }
+    }
+}
+
+std::shared_ptr<const HpaLayout> buildHpaLayout(const Grid& g, int clusterSize)
+{
+    auto L = std::make_shared<HpaLayout>();
+    L->clusterSize = clusterSize;
+    L->cw = (g.w + clusterSize - 1) / clusterSize;
+    L->ch = (g.h + clusterSize - 1) / clusterSize;
+    L->clusterNodes.resize(L->cw * L->ch);
+
+    std::unordered_map<int, int> nodeAt;  // cell index -> node id
+    auto nodeFor = [&](IVec2 p) {
+        int key = p.y * g.w + p.x;
+        auto it = nodeAt.find(key);
+        if (it != nodeAt.end()) return it->second;
+        int id = (int)L->nodes.size();
+        int c = L->clusterOf(p);
+        L->nodes.push_back(p);
+        L->nodeCluster.push_back(c);
+        L->nodeLocal.push_back((int)L->clusterNodes[c].size());
+        L->clusterNodes[c].push_back(id);
+        L->inter.emplace_back();
+        nodeAt.emplace(key, id);
+        return id;
+    };
+    auto link = [&](IVec2 a, IVec2 b) {
+        int na = nodeFor(a), nb = nodeFor(b);
+        L->inter[na].push_back(nb);
+        L->inter[nb].push_back(na);
+    };
+
+    // Open stretches of a border become one entrance (short) or two (long, one per end)
+    auto addRun = [&](IVec2 a0, IVec2 b0, IVec2 along, int len) {
+        if (len <= 0) return;
+        if (len < 6) {
+            int m = len / 2;
+            link(a0 + along * m, b0 + along * m);
+        } else {
+            link(a0, b0);
+            link(a0 + along * (len - 1), b0 + along * (len - 1));
+        }
+    };
+
+    // Vertical borders (between horizontally adjacent clusters)
+    for (int x = clusterSize; x < g.w; x += clusterSize) {
+        int runStart = -1;
+        for (int y = 0; y <= g.h; ++y) {
+            bool open = y < g.h && g.passable({ x - 1, y }) && g.passable({ x, y });
+            bool newCluster = y < g.h && y % clusterSize == 0;
+            if (runStart >= 0 && (!open || newCluster)) {
+                addRun({ x - 1, runStart }, { x, runStart }, { 0, 1 }, y - runStart);
+                runStart = -1;
+            }
+            if (open && runStart < 0) runStart = y;
+        }
+    }
+
+    // Horizontal borders (between vertically adjacent clusters)
+    for (int y = clusterSize; y < g.h; y += clusterSize) {
+        int runStart = -1;
+        for (int x = 0; x <= g.w; ++x) {
+            bool open = x < g.w && g.passable({ x, y - 1 }) && g.passable({ x, y });
+            bool newCluster = x < g.w && x % clusterSize == 0;
+            if (runStart >= 0 && (!open || newCluster)) {
+                addRun({ runStart, y - 1 }, { runStart, y }, { 1, 0 }, x - runStart);
+                runStart = -1;
+            }
+            if (open && runStart < 0) runStart = x;
+        }
+    }
+
+    L->clusterSlot.resize(L->clusterNodes.size());
+    for (size_t c = 0; c < L->clusterNodes.size(); ++c) {
+        L->clusterSlot[c] = L->slotCount;
+        int k = (int)L->clusterNodes[c].size();
+        L->slotCount += k * k;
+    }
+    return L;
+}
+
+void HpaCosts::refresh(const Grid& g, const HpaLayout& L, const RiskMap& risk)
+{
+    bool full = (int)cost.size() != L.slotCount || riskSeen.width() != risk.width() ||
+                riskSeen.height() != risk.height() || riskSeen.fillValue() != risk.fillValue();
+    if (full) cost.assign(L.slotCount, kInf);
+
+    lastRefreshed = 0;
+    int clusters = L.cw * L.ch;
+    for (int c = 0; c < clusters; ++c) {
+        bool changed = full;
+        if (!changed) {
+            IVec2 lo, hi;
+            L.clusterRect(g, c, lo, hi);
+            // A cluster inside a chunk asleep in both layers is unchanged
+            int chunk = risk.chunkOf(lo.x, lo.y);
+            if (kChunkSize % L.clusterSize == 0 && !risk.chunk(chunk) && !riskSeen.chunk(chunk)) continue;
+            for (int y = lo.y; y <= hi.y && !changed; ++y)
+                for (int x = lo.x; x <= hi.x; ++x)
+                    if (riskAt(risk, g, { x, y }) != riskAt(riskSeen, g, { x, y })) { changed = true; break; }
+        }
+        if (changed) {
+            refreshCluster(g, L, c, risk, alpha, cost);
+            lastRefreshed++;
+        }
+    }
+    riskSeen = risk;
+}
+
+std::vector<IVec2> hpaPath(const Grid& g, const HpaLayout& L, const HpaCosts& costs,
+                           IVec2 start, IVec2 goal,
+                           const RiskMap& risk, float alpha)
+{
+    int sc = L.clusterOf(start), gc = L.clusterOf(goal);
+    IVec2 lo, hi;
+
+    if (sc == gc) {
+        L.clusterRect(g, sc, lo, hi);
+        auto local = aStarPathInRect(g, start, goal, risk, alpha, lo, hi);
+        if (local.back() == goal) return local;
+        return aStarPath(g, start, goal, risk, alpha);
+    }
+
+    // Temporary abstract nodes for start and goal
+    const int N = (int)L.nodes.size();
+    const int S = N, G = N + 1;
+    auto posOf = [&](int n) { return n == S ? start : n == G ? goal : L.nodes[n]; };
+
+    std::vector<float> startDist, goalDist;
+    IVec2 slo, shi, glo, ghi;
+    L.clusterRect(g, sc, slo, shi);
+    L.clusterRect(g, gc, glo, ghi);
+    clusterDijkstra(g, slo, shi, start, risk, costs.alpha, false, startDist);
+    clusterDijkstra(g, glo, ghi, goal, risk, costs.alpha, true, goalDist);
+    auto distIn = [&](const std::vector<float>& d, IVec2 clo, IVec2 chi, IVec2 p) {
+        return d[(p.y - clo.y) * (chi.x - clo.x + 1) + (p.x - clo.x)];
+    };
+
+    struct Item { float f, g; int n; };
+    struct Cmp { bool operator()(const Item& a, const Item& b) const { return a.f > b.f; } };
+    std::priority_queue<Item, std::vector<Item>, Cmp> open;
+    std::unordered_map<int, float> gs;
+    std::unordered_map<int, int> came;
+    const Landmarks* lm = g.landmarks.get();
+    const std::uint16_t* goalRow = lm ? lm->row(goal.y * g.w + goal.x) : nullptr;
+    auto h = [&](int n) {
+        IVec2 p = posOf(n);
+        int m = p.manhattan(goal);
+        return (float)(lm ? std::max(m, lm->lowerBound(p.y * g.w + p.x, goalRow)) : m);
+    };
+
+    gs[S] = 0.f;
+    open.push({ h(S), 0.f, S });
+
+    auto relax = [&](int from, int to, float c) {
+        if (c == kInf) return;
+        float nd = gs[from] + c;
+        auto it = gs.find(to);
+        if (it == gs.end() || nd < it->second) {
+            gs[to] = nd;
+            came[to] = from;
+            open.push({ nd + h(to), nd, to });
+        }
+    };
+
+    bool found = false;
+    int pops = 0;
+    while (!open.empty()) {
+        Item cur = open.top();
+        open.pop();
+        if (cur.g > gs[cur.n]) continue;   // stale entry
+        pops++;
+        if (cur.n == G) { found = true; break; }
+
+        if (cur.n == S) {
+            for (int m : L.clusterNodes[sc])
+                relax(S, m, distIn(startDist, slo, shi, L.nodes[m]));
+            continue;
+        }
+
+        int c = L.nodeCluster[cur.n];
+        const auto& ns = L.clusterNodes[c];
+        int k = (int)ns.size(), i = L.nodeLocal[cur.n];
+        for (int j = 0; j < k; ++j)
+            if (j != i) relax(cur.n, ns[j], costs.cost[L.clusterSlot[c] + i * k + j]);
+        for (int m : L.inter[cur.n]) {
+            IVec2 q = L.nodes[m];
+            relax(cur.n, m, 1.0f + costs.alpha * riskAt(risk, g, q));
+        }
+        if (c == gc)
+            relax(cur.n, G, distIn(goalDist, glo, ghi, L.nodes[cur.n]));
+    }
+
+    metrics::add(Counter::HpaCalls);
+    metrics::add(Counter::HpaNodes, pops);
+    metrics::record(Histogram::HpaNodes, pops);
+    if (!found)
+        return aStarPath(g, start, goal, risk, alpha);
+
+    std::vector<int> hops;
+    for (int n = G; n != S; n = came[n]) hops.push_back(n);
+    hops.push_back(S);
+    std::reverse(hops.begin(), hops.end());
+
+    // Refine each hop locally with the caller's alpha
+    std::vector<IVec2> path{ start };
+    for (size_t i = 0; i + 1 < hops.size(); ++i) {
+        IVec2 a = posOf(hops[i]), b = posOf(hops[i + 1]);
+        if (a.manhattan(b) == 1 && L.clusterOf(a) != L.clusterOf(b)) {
+            path.push_back(b);
+            continue;
+        }
+        L.clusterRect(g, L.clusterOf(a), lo, hi);
+        auto seg = aStarPathInRect(g, a, b, risk, alpha, lo, hi);
+        if (seg.back() != b)
+            return aStarPath(g, start, goal, risk, alpha);
+        path.insert(path.end(), seg.begin() + 1, seg.end());
+    }
+    return path;
+}
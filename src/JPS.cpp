@@ -0,0 +1,201 @@
+// JPS.cpp - Jump point search on 4-connected uniform-cost regions
+// Used by the path service instead of A* when the risk field is flat over
+// the search area (or ignored with alpha = 0).
+
+#include "JPS.h"
+#include "RadixHeap.h"
+#include "SearchScratch.h"
+#include "Metrics.h"
+#include <limits>
+#include <algorithm>
+
+namespace
+{
+    struct Area {
+        const Grid& g;
+        IVec2 lo, hi;
+        const JpsRuns* runs;
+
+        bool open(int x, int y) const {
+            return x >= lo.x && y >= lo.y && x <= hi.x && y <= hi.y && g.passable({ x, y });
+        }
+    };
+
+    // A cell reached moving vertically may only turn sideways where the cell
+    // beside it one step back is blocked; otherwise turning earlier is as short
+    bool forcedSide(const Area& a, int x, int y, int dy, int side) {
+        return a.open(x + side, y) && !a.open(x + side, y - dy);
+    }
+
+    bool jumpV(const Area& a, IVec2 p, int dy, IVec2 goal, IVec2& out)
+    {
+        int x = p.x, y = p.y;
+        if (a.runs) {
+            // The run stops at the first blocked or globally forced cell. Forced
+            // inside the area implies forced on the map, so no jump point is
+            // missed; extra ones at the area's sides only cost a pop.
+            int n = (dy > 0 ? a.runs->down : a.runs->up)[y * a.g.w + x];
+            int toGoal = (goal.y - y) * dy;
+            if (x == goal.x && toGoal > 0 && toGoal <= n) {
+                out = goal;
+                return true;
+            }
+            int ty = y + n * dy;
+            if (!a.open(x, ty)) return false;
+            out = { x, ty };
+            return true;
+        }
+        while (true) {
+            y += dy;
+            if (!a.open(x, y)) return false;
+            if ((x == goal.x && y == goal.y) || forcedSide(a, x, y, dy, 1) || forcedSide(a, x, y, dy, -1)) {
+                out = { x, y };
+                return true;
+            }
+        }
+    }
+
+    // Horizontal runs stop wherever a vertical run from the cell finds something
+    bool jumpH(const Area& a, IVec2 p, int dx, IVec2 goal, IVec2& out)
+    {
+        int x = p.x, y = p.y;
+        IVec2 unused;
+        while (true) {
+            x += dx;
+            if (!a.open(x, y)) return false;
+            if ((x == goal.x && y == goal.y) ||
+                jumpV(a, { x, y }, 1, goal, unused) || jumpV(a, { x, y }, -1, goal, unused)) {
+                out = { x, y };
+                return true;
+            }
+        }
+    }
+
+    int sign(int v) { return (v > 0) - (v < 0); }
+}
+
+std::shared_ptr<const JpsRuns> buildJpsRuns(const Grid& g)
+{
+    auto runs = std::make_shared<JpsRuns>();
+    runs->down.resize(g.w * g.h);
+    runs->up.resize(g.w * g.h);
+
+    Area whole{ g, { 0, 0 }, { g.w - 1, g.h - 1 }, nullptr };
+    auto stop = [&](int x, int y, int dy) {
+        return !whole.open(x, y) || forcedSide(whole, x, y, dy, 1) || forcedSide(whole, x, y, dy, -1);
+    };
+    for (int x = 0; x < g.w; ++x) {
+        for (int y = g.h - 1; y >= 0; --y) {
+            int ny = y + 1;
+            runs->down[y * g.w + x] = (ny >= g.h || stop(x, ny, 1)) ? 1 : runs->down[ny * g.w + x] + 1;
+        }
+        for (int y = 0; y < g.h; ++y) {
+            int ny = y - 1;
+            runs->up[y * g.w + x] = (ny < 0 || stop(x, ny, -1)) ? 1 : runs->up[ny * g.w + x] + 1;
+        }
+    }
+    return runs;
+}
+
+bool riskFlat(const Grid& g, const RiskMap& risk, IVec2 lo, IVec2 hi)
+{
+    bool seen = false;
+    float level = 0.f;
+    for (int y = lo.y; y <= hi.y; ++y) {
+        for (int x = lo.x; x <= hi.x; ++x) {
+            if (!g.passable({ x, y })) continue;
+            float r = riskAt(risk, g, { x, y });
+            if (!seen) { level = r; seen = true; }
+            else if (r != level) return false;
+        }
+    }
+    return true;
+}
+
+std::vector<IVec2> jpsPath(const Grid& g, IVec2 start, IVec2 goal, IVec2 lo, IVec2 hi, int* expanded)
+{
+    std::vector<IVec2> path;
+    jpsPath(g, start, goal, lo, hi, path, expanded);
+    return path;
+}
+
+void jpsPath(const Grid& g, IVec2 start, IVec2 goal, IVec2 lo, IVec2 hi, std::vector<IVec2>& path, int* expanded)
+{
+    Area area{ g, lo, hi, g.jpsRuns.get() };
+    int rw = hi.x - lo.x + 1, rh = hi.y - lo.y + 1;
+    auto lidx = [&](IVec2 p) { return (p.y - lo.y) * rw + (p.x - lo.x); };
+    auto at = [&](int i) { return IVec2{ lo.x + i % rw, lo.y + i / rw }; };
+
+    // Reused across calls on this thread, as in aStarPathInRect
+    thread_local RadixHeap<int> open;
+    open.clear();
+    SearchScratch& scratch = SearchScratch::forThread();
+    scratch.begin(rw, rh);
+    auto node = [&](IVec2 p) -> SearchScratch::Node& { return scratch.at(p.x - lo.x, p.y - lo.y); };
+
+    int si = lidx(start), gi = lidx(goal);
+    node(start).g = 0;
+    open.push(start.manhattan(goal), si);
+
+    int pops = 0;
+    bool found = false;
+    while (!open.empty()) {
+        int ci = open.pop();
+        IVec2 p = at(ci);
+        SearchScratch::Node& cn = node(p);
+        if (cn.closed) continue;
+        cn.closed = true;
+        pops++;
+        if (ci == gi) { found = true; break; }
+
+        auto push = [&](IVec2 q) {
+            SearchScratch::Node& qn = node(q);
+            std::uint32_t ng = cn.g + p.manhattan(q);
+            if (qn.closed || ng >= qn.g) return;
+            qn.g = ng;
+            qn.parent = ci;
+            open.push(ng + q.manhattan(goal), lidx(q));
+        };
+
+        IVec2 q;
+        if (cn.parent < 0) {
+            for (int d : { 1, -1 }) {
+                if (jumpH(area, p, d, goal, q)) push(q);
+                if (jumpV(area, p, d, goal, q)) push(q);
+            }
+            continue;
+        }
+
+        IVec2 from = at(cn.parent);
+        int dx = sign(p.x - from.x), dy = sign(p.y - from.y);
+        if (dx != 0) {
+            if (jumpH(area, p, dx, goal, q)) push(q);
+            if (jumpV(area, p, 1, goal, q)) push(q);
+            if (jumpV(area, p, -1, goal, q)) push(q);
+        } else {
+            if (jumpV(area, p, dy, goal, q)) push(q);
+            for (int side : { 1, -1 })
+                if (forcedSide(area, p.x, p.y, dy, side) && jumpH(area, p, side, goal, q)) push(q);
+        }
+    }
+    if (expanded) *expanded = pops;
+    metrics::add(Counter::JpsCalls);
+    metrics::add(Counter::JpsNodes, pops);
+    metrics::record(Histogram::JpsNodes, pops);
+
+    path.clear();
+    if (!found) {
+        path.push_back(start);
+        return;
+    }
+
+    // Jump points are joined by straight runs; fill in the cells between
+    path.push_back(goal);
+    for (int i = gi, pi; (pi = node(at(i)).parent) >= 0; i = pi) {
+        IVec2 a = at(i), b = at(pi);
+        IVec2 step{ sign(b.x - a.x), sign(b.y - a.y) };
+        for (IVec2 c = a + step; c != b; c = c + step) path.push_back(c);
+        path.push_back(b);
+    }
+    std::reverse(path.begin(), path.end());
+}
@@ -0,0 +1,142 @@
+// Landmarks.cpp - Landmark distance fields for the ALT heuristic
+// Built once per map (or read back from the cache file next to it) and
+// shared by every A* query on that map.
+
+#include "Landmarks.h"
+#include <fstream>
+#include <cstring>
+
+namespace
+{
+    const char kMagic[4] = { 'A', 'I', 'L', 'M' };
+    constexpr std::uint32_t kFormatVersion = 1;
+
+    // Unit-cost flood over passable cells; unreached cells stay at kFar
+    void flood(const Grid& g, IVec2 src, std::vector<std::uint16_t>& d)
+    {
+        d.assign(g.w * g.h, Landmarks::kFar);
+        std::vector<int> frontier{ src.y * g.w + src.x }, next;
+        d[frontier[0]] = 0;
+
+        static const int dx[4] = { 1, -1, 0, 0 };
+        static const int dy[4] = { 0, 0, 1, -1 };
+        for (int step = 1; !frontier.empty(); ++step) {
+            // Beyond 16 bits the distance is simply unknown
+            if (step >= Landmarks::kFar) break;
+            next.clear();
+            for (int c : frontier) {
+                int x = c % g.w, y = c / g.w;
+                for (int i = 0; i < 4; ++i) {
+                    IVec2 q{ x + dx[i], y + dy[i] };
+                    if (!g.inBounds(q) || !g.passable(q)) continue;
+                    int qi = q.y * g.w + q.x;
+                    if (d[qi] != Landmarks::kFar) continue;
+                    d[qi] = (std::uint16_t)step;
+                    next.push_back(qi);
+                }
+            }
+            frontier.swap(next);
+        }
+    }
+
+    // FNV-1a over the layout, so a cache file never outlives an edited map
+    std::uint64_t mapHash(const Grid& g)
+    {
+        std::uint64_t hsh = 1469598103934665603ull;
+        auto mix = [&](const void* p, std::size_t n) {
+            auto b = static_cast<const unsigned char*>(p);
+            for (std::size_t i = 0; i < n; ++i) { hsh ^= b[i]; hsh *= 1099511628211ull; }
+        };
+        mix(&g.w, sizeof g.w);
+        mix(&g.h, sizeof g.h);
+        mix(g.cells.data(), g.cells.size() * sizeof(Tile));
+        return hsh;
+    }
+}
+
+std::shared_ptr<const Landmarks> buildLandmarks(const Grid& g, int count)
+{
+    auto lm = std::make_shared<Landmarks>();
+    lm->w = g.w;
+    lm->h = g.h;
+
+    IVec2 seed{ -1, -1 };
+    for (int i = 0; i < g.w * g.h && seed.x < 0; ++i)
+        if (g.passable({ i % g.w, i / g.w })) seed = { i % g.w, i / g.w };
+    if (seed.x < 0) return lm;
+
+    // Farthest-point sampling: the first landmark is the cell farthest from
+    // an arbitrary seed, each next one the cell farthest from all chosen so far
+    std::vector<std::uint16_t> d, nearest;
+    flood(g, seed, nearest);
+    std::vector<std::vector<std::uint16_t>> fields;
+    for (int k = 0; k < count; ++k) {
+        int pick = -1;
+        for (int c = 0; c < g.w * g.h; ++c)
+            if (nearest[c] != Landmarks::kFar && (pick < 0 || nearest[c] > nearest[pick])) pick = c;
+        if (pick < 0 || (k > 0 && nearest[pick] == 0)) break;
+
+        IVec2 p{ pick % g.w, pick / g.w };
+        flood(g, p, d);
+        lm->points.push_back(p);
+        for (int c = 0; c < g.w * g.h; ++c)
+            nearest[c] = (k == 0) ? d[c] : std::min(nearest[c], d[c]);
+        fields.push_back(d);
+    }
+
+    lm->count = (int)fields.size();
+    lm->dist.resize((std::size_t)g.w * g.h * lm->count);
+    for (int c = 0; c < g.w * g.h; ++c)
+        for (int i = 0; i < lm->count; ++i)
+            lm->dist[(std::size_t)c * lm->count + i] = fields[i][c];
+    return lm;
+}
+
+std::shared_ptr<const Landmarks> loadLandmarks(const Grid& g, const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return nullptr;
+
+    char magic[4];
+    std::uint32_t version = 0;
+    std::uint64_t hsh = 0;
+    std::int32_t w = 0, h = 0, count = 0;
+    in.read(magic, 4);
+    in.read(reinterpret_cast<char*>(&version), sizeof version);
+    in.read(reinterpret_cast<char*>(&hsh), sizeof hsh);
+    in.read(reinterpret_cast<char*>(&w), sizeof w);
+    in.read(reinterpret_cast<char*>(&h), sizeof h);
+    in.read(reinterpret_cast<char*>(&count), sizeof count);
+    if (!in || std::memcmp(magic, kMagic, 4) != 0 || version != kFormatVersion ||
+        hsh != mapHash(g) || w != g.w || h != g.h || count < 0 || count > kLandmarkCount)
+        return nullptr;
+
+    auto lm = std::make_shared<Landmarks>();
+    lm->w = w;
+    lm->h = h;
+    lm->count = count;
+    lm->points.resize(count);
+    lm->dist.resize((std::size_t)w * h * count);
+    in.read(reinterpret_cast<char*>(lm->points.data()), count * sizeof(IVec2));
+    in.read(reinterpret_cast<char*>(lm->dist.data()), lm->dist.size() * sizeof(std::uint16_t));
+    if (!in) return nullptr;
+    return lm;
+}
+
+bool saveLandmarks(const Grid& g, const Landmarks& lm, const std::string& path)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    std::uint64_t hsh = mapHash(g);
+    std::int32_t w = lm.w, h = lm.h, count = lm.count;
+    out.write(kMagic, 4);
+    out.write(reinterpret_cast<const char*>(&kFormatVersion), sizeof kFormatVersion);
+    out.write(reinterpret_cast<const char*>(&hsh), sizeof hsh);
+    out.write(reinterpret_cast<const char*>(&w), sizeof w);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    out.write(reinterpret_cast<const char*>(&count), sizeof count);
+    out.write(reinterpret_cast<const char*>(lm.points.data()), lm.points.size() * sizeof(IVec2));
+    out.write(reinterpret_cast<const char*>(lm.dist.data()), lm.dist.size() * sizeof(std::uint16_t));
+    return (bool)out;
+}
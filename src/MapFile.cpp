@@ -0,0 +1,402 @@
+// MapFile.cpp - Binary .aimap maps read through a memory mapping, and the
+// parallel ASCII map importer used for text maps.
+
+#include "MapFile.h"
+#include "Landmarks.h"
+#include "JPS.h"
+#include "HPAStar.h"
+#include "TaskPool.h"
+#include <fstream>
+#include <vector>
+#include <array>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path)
+{
+    std::shared_ptr<MappedFile> f(new MappedFile());
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    f->file = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return nullptr;
+    f->mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!f->mapping) return nullptr;
+    f->bytes = static_cast<const unsigned char*>(MapViewOfFile(f->mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!f->bytes) return nullptr;
+    f->length = (std::size_t)size.QuadPart;
+#else
+    f->fd = ::open(path.c_str(), O_RDONLY);
+    if (f->fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(f->fd, &st) != 0 || st.st_size == 0) return nullptr;
+    void* p = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, f->fd, 0);
+    if (p == MAP_FAILED) return nullptr;
+    f->bytes = static_cast<const unsigned char*>(p);
+    f->length = (std::size_t)st.st_size;
+#endif
+    return f;
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+#else
+    if (bytes) munmap(const_cast<unsigned char*>(bytes), length);
+    if (fd >= 0) ::close(fd);
+#endif
+}
+
+namespace
+{
+    const char kMagic[4] = { 'A', 'I', 'M', 'P' };
+    constexpr std::uint32_t kFormatVersion = 1;
+
+    enum LayerKind : std::uint32_t {
+        kLayerTiles = 1, kLayerCover, kLayerLandmarks, kLayerJpsRuns, kLayerClusters
+    };
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::int32_t w, h;
+        IVec2 blueAmmo, blueMed, orangeAmmo, orangeMed;
+        std::uint32_t layerCount;
+        std::uint32_t reserved;
+    };
+
+    struct LayerEntry {
+        std::uint32_t kind;
+        std::uint32_t count;        // landmarks: number of landmarks, else 0
+        std::uint64_t offset;
+        std::uint64_t bytes;
+    };
+
+    static_assert(sizeof(Header) == 56 && sizeof(LayerEntry) == 24, ".aimap records must stay packed");
+
+    std::size_t align8(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+    // HPA* clusters: node and edge counts, entrance cells, then the border
+    // links as offsets (nodes + 1) into one list of neighbour ids
+    std::vector<unsigned char> packClusters(const HpaLayout& L)
+    {
+        std::uint32_t nodes = (std::uint32_t)L.nodes.size(), edges = 0;
+        std::vector<std::int32_t> start{ 0 }, ids;
+        for (auto& links : L.inter) {
+            ids.insert(ids.end(), links.begin(), links.end());
+            start.push_back((std::int32_t)ids.size());
+        }
+        edges = (std::uint32_t)ids.size();
+
+        std::vector<unsigned char> out(8 + nodes * sizeof(IVec2) + start.size() * 4 + ids.size() * 4);
+        unsigned char* p = out.data();
+        std::memcpy(p, &nodes, 4);
+        std::memcpy(p + 4, &edges, 4);
+        p += 8;
+        std::memcpy(p, L.nodes.data(), nodes * sizeof(IVec2));
+        p += nodes * sizeof(IVec2);
+        std::memcpy(p, start.data(), start.size() * 4);
+        p += start.size() * 4;
+        std::memcpy(p, ids.data(), ids.size() * 4);
+        return out;
+    }
+
+    // The per-cluster tables follow from node order, as in buildHpaLayout
+    std::shared_ptr<const HpaLayout> unpackClusters(const Grid& g, int clusterSize,
+                                                    const unsigned char* p, std::size_t bytes)
+    {
+        std::uint32_t nodes, edges;
+        if (bytes < 8) return nullptr;
+        std::memcpy(&nodes, p, 4);
+        std::memcpy(&edges, p + 4, 4);
+        if (bytes != 8 + (std::size_t)nodes * sizeof(IVec2) + ((std::size_t)nodes + 1) * 4 + (std::size_t)edges * 4)
+            return nullptr;
+        p += 8;
+
+        auto L = std::make_shared<HpaLayout>();
+        L->clusterSize = clusterSize;
+        L->cw = (g.w + clusterSize - 1) / clusterSize;
+        L->ch = (g.h + clusterSize - 1) / clusterSize;
+        L->clusterNodes.resize(L->cw * L->ch);
+        L->nodes.resize(nodes);
+        std::memcpy(L->nodes.data(), p, nodes * sizeof(IVec2));
+        p += nodes * sizeof(IVec2);
+        const std::int32_t* start = reinterpret_cast<const std::int32_t*>(p);
+        const std::int32_t* ids = start + nodes + 1;
+
+        // Sizes alone do not make the tables safe to index
+        for (std::uint32_t i = 0; i < nodes; ++i)
+            if (!g.inBounds(L->nodes[i])) return nullptr;
+        if (start[0] != 0 || (std::uint32_t)start[nodes] != edges) return nullptr;
+        for (std::uint32_t i = 0; i < nodes; ++i)
+            if (start[i + 1] < start[i]) return nullptr;
+        for (std::uint32_t k = 0; k < edges; ++k)
+            if (ids[k] < 0 || (std::uint32_t)ids[k] >= nodes) return nullptr;
+
+        L->nodeCluster.resize(nodes);
+        L->nodeLocal.resize(nodes);
+        L->inter.resize(nodes);
+        for (std::uint32_t i = 0; i < nodes; ++i) {
+            int c = L->clusterOf(L->nodes[i]);
+            L->nodeCluster[i] = c;
+            L->nodeLocal[i] = (int)L->clusterNodes[c].size();
+            L->clusterNodes[c].push_back((int)i);
+            L->inter[i].assign(ids + start[i], ids + start[i + 1]);
+        }
+        L->clusterSlot.resize(L->clusterNodes.size());
+        for (size_t c = 0; c < L->clusterNodes.size(); ++c) {
+            L->clusterSlot[c] = L->slotCount;
+            int k = (int)L->clusterNodes[c].size();
+            L->slotCount += k * k;
+        }
+        return L;
+    }
+
+    // Character to tile, the same mapping the text format always used
+    const std::array<Tile, 256>& tileTable()
+    {
+        static const std::array<Tile, 256> table = [] {
+            std::array<Tile, 256> t;
+            t.fill(Tile::Open);
+            t['#'] = Tile::Rock;
+            t['T'] = Tile::Tree;
+            t['~'] = Tile::Water;
+            t['A'] = t['a'] = Tile::DepotAmmo;
+            t['M'] = t['m'] = Tile::DepotMed;
+            return t;
+        }();
+        return table;
+    }
+}
+
+bool readAimap(const std::string& path, Grid& g)
+{
+    auto file = MappedFile::open(path);
+    if (!file || file->size() < sizeof(Header)) return false;
+
+    const unsigned char* base = file->data();
+    Header hd;
+    std::memcpy(&hd, base, sizeof hd);
+    if (std::memcmp(hd.magic, kMagic, 4) != 0 || hd.version != kFormatVersion) return false;
+    if (hd.w <= 0 || hd.h <= 0) return false;
+    if (sizeof(Header) + (std::uint64_t)hd.layerCount * sizeof(LayerEntry) > file->size()) return false;
+
+    const std::size_t cells = (std::size_t)hd.w * hd.h;
+    g = Grid();
+    g.w = hd.w;
+    g.h = hd.h;
+    for (IVec2 depot : { hd.blueAmmo, hd.blueMed, hd.orangeAmmo, hd.orangeMed })
+        if (!g.inBounds(depot)) return false;
+    g.blueAmmo = hd.blueAmmo;
+    g.blueMed = hd.blueMed;
+    g.orangeAmmo = hd.orangeAmmo;
+    g.orangeMed = hd.orangeMed;
+
+    bool haveTiles = false;
+    for (std::uint32_t i = 0; i < hd.layerCount; ++i) {
+        LayerEntry e;
+        std::memcpy(&e, base + sizeof(Header) + i * sizeof(LayerEntry), sizeof e);
+        if (e.offset % 8 != 0 || e.offset > file->size() || e.bytes > file->size() - e.offset) return false;
+        const unsigned char* p = base + e.offset;
+
+        switch (e.kind) {
+        case kLayerTiles:
+            if (e.bytes != cells) return false;
+            for (std::size_t c = 0; c < cells; ++c)
+                if (p[c] > (unsigned char)Tile::DepotMed) return false;
+            g.cells.resize(cells);
+            std::memcpy(g.cells.data(), p, cells);
+            haveTiles = true;
+            break;
+        case kLayerCover:
+            if (e.bytes != cells * sizeof(float)) return false;
+            g.cover.resize(cells);
+            std::memcpy(g.cover.data(), p, e.bytes);
+            break;
+        case kLayerLandmarks: {
+            std::size_t pointBytes = e.count * sizeof(IVec2);
+            if (e.bytes != pointBytes + cells * e.count * sizeof(std::uint16_t)) return false;
+            auto lm = std::make_shared<Landmarks>();
+            lm->w = g.w;
+            lm->h = g.h;
+            lm->count = (int)e.count;
+            lm->points.resize(e.count);
+            std::memcpy(lm->points.data(), p, pointBytes);
+            for (IVec2 q : lm->points)
+                if (!g.inBounds(q)) return false;
+            lm->mapped = reinterpret_cast<const std::uint16_t*>(p + pointBytes);
+            lm->keepAlive = file;
+            g.landmarks = lm;
+            break;
+        }
+        case kLayerJpsRuns: {
+            if (e.bytes != 2 * cells * sizeof(std::uint16_t)) return false;
+            auto runs = std::make_shared<JpsRuns>();
+            runs->down.resize(cells);
+            runs->up.resize(cells);
+            std::memcpy(runs->down.data(), p, cells * sizeof(std::uint16_t));
+            std::memcpy(runs->up.data(), p + cells * sizeof(std::uint16_t), cells * sizeof(std::uint16_t));
+            // A run may end on the last row or column cell, never past it
+            for (int y = 0; y < g.h; ++y)
+                for (int x = 0; x < g.w; ++x) {
+                    int down = runs->down[(std::size_t)y * g.w + x], up = runs->up[(std::size_t)y * g.w + x];
+                    if (down < 1 || down > g.h - y || up < 1 || up > y + 1) return false;
+                }
+            g.jpsRuns = runs;
+            break;
+        }
+        case kLayerClusters:
+            if (e.count == 0) return false;
+            g.hpa = unpackClusters(g, (int)e.count, p, (std::size_t)e.bytes);
+            if (!g.hpa) return false;
+            break;
+        default:
+            break;      // written by a newer build; safe to ignore
+        }
+    }
+    return haveTiles;
+}
+
+bool writeAimap(const Grid& g, const std::string& path, bool withLayers)
+{
+    const std::size_t cells = (std::size_t)g.w * g.h;
+    struct Payload { LayerEntry entry; const void* a; std::size_t aBytes; const void* b; std::size_t bBytes; };
+    std::vector<Payload> layers;
+    std::vector<unsigned char> clusters;
+    layers.push_back({ { kLayerTiles, 0, 0, cells }, g.cells.data(), cells, nullptr, 0 });
+    if (withLayers) {
+        if (g.cover.size() == cells)
+            layers.push_back({ { kLayerCover, 0, 0, cells * sizeof(float) },
+                               g.cover.data(), cells * sizeof(float), nullptr, 0 });
+        if (g.landmarks && g.landmarks->count > 0) {
+            const Landmarks& lm = *g.landmarks;
+            std::size_t pointBytes = lm.points.size() * sizeof(IVec2);
+            std::size_t distBytes = cells * lm.count * sizeof(std::uint16_t);
+            layers.push_back({ { kLayerLandmarks, (std::uint32_t)lm.count, 0, pointBytes + distBytes },
+                               lm.points.data(), pointBytes, lm.row(0), distBytes });
+        }
+        if (g.hpa) {
+            clusters = packClusters(*g.hpa);
+            layers.push_back({ { kLayerClusters, (std::uint32_t)g.hpa->clusterSize, 0, clusters.size() },
+                               clusters.data(), clusters.size(), nullptr, 0 });
+        }
+        if (g.jpsRuns) {
+            std::size_t plane = cells * sizeof(std::uint16_t);
+            layers.push_back({ { kLayerJpsRuns, 0, 0, 2 * plane },
+                               g.jpsRuns->down.data(), plane, g.jpsRuns->up.data(), plane });
+        }
+    }
+
+    Header hd{};
+    std::memcpy(hd.magic, kMagic, 4);
+    hd.version = kFormatVersion;
+    hd.w = g.w;
+    hd.h = g.h;
+    hd.blueAmmo = g.blueAmmo;
+    hd.blueMed = g.blueMed;
+    hd.orangeAmmo = g.orangeAmmo;
+    hd.orangeMed = g.orangeMed;
+    hd.layerCount = (std::uint32_t)layers.size();
+
+    std::size_t offset = align8(sizeof(Header) + layers.size() * sizeof(LayerEntry));
+    for (auto& l : layers) {
+        l.entry.offset = offset;
+        offset = align8(offset + (std::size_t)l.entry.bytes);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(reinterpret_cast<const char*>(&hd), sizeof hd);
+    for (auto& l : layers) out.write(reinterpret_cast<const char*>(&l.entry), sizeof l.entry);
+
+    const char zeros[8] = {};
+    std::size_t pos = sizeof(Header) + layers.size() * sizeof(LayerEntry);
+    for (auto& l : layers) {
+        out.write(zeros, l.entry.offset - pos);
+        out.write(static_cast<const char*>(l.a), l.aBytes);
+        if (l.b) out.write(static_cast<const char*>(l.b), l.bBytes);
+        pos = l.entry.offset + l.entry.bytes;
+    }
+    return (bool)out;
+}
+
+bool readAsciiMap(const std::string& path, Grid& g)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    in.seekg(0, std::ios::end);
+    std::string text((std::size_t)in.tellg(), '\0');
+    in.seekg(0);
+    in.read(&text[0], text.size());
+
+    // Row starts and lengths; blank lines are skipped and CRs dropped
+    struct Row { std::size_t start, len; };
+    std::vector<Row> rows;
+    for (std::size_t pos = 0; pos < text.size(); ) {
+        const void* nl = std::memchr(text.data() + pos, '\n', text.size() - pos);
+        std::size_t end = nl ? (std::size_t)(static_cast<const char*>(nl) - text.data()) : text.size();
+        std::size_t len = end - pos;
+        if (len > 0 && text[pos + len - 1] == '\r') --len;
+        if (len > 0) rows.push_back({ pos, len });
+        pos = end + 1;
+    }
+    if (rows.empty()) return false;
+
+    g.h = (int)rows.size();
+    g.w = (int)rows[0].len;
+    g.cells.resize((std::size_t)g.w * g.h);
+
+    // Each block remembers the last depot of each kind it saw; merged in row
+    // order below, so later depots win as they did with the serial reader
+    enum { kBlueAmmo, kBlueMed, kOrangeAmmo, kOrangeMed };
+    int blocks = (g.h + kImportRowBlock - 1) / kImportRowBlock;
+    std::vector<std::array<IVec2, 4>> found(blocks);
+    const auto& table = tileTable();
+
+    TaskPool::shared().parallelFor(blocks, [&](int b) {
+        auto& depots = found[b];
+        depots.fill({ -1, -1 });
+        int y1 = std::min(g.h, (b + 1) * kImportRowBlock);
+        for (int y = b * kImportRowBlock; y < y1; ++y) {
+            const char* src = text.data() + rows[y].start;
+            int len = std::min(g.w, (int)rows[y].len);
+            Tile* dst = &g.cells[(std::size_t)y * g.w];
+            for (int x = 0; x < len; ++x) {
+                char c = src[x];
+                dst[x] = table[(unsigned char)c];
+                if (dst[x] < Tile::DepotAmmo) continue;
+                switch (c) {
+                case 'A': depots[kBlueAmmo] = { x, y }; break;
+                case 'M': depots[kBlueMed] = { x, y }; break;
+                case 'a': depots[kOrangeAmmo] = { x, y }; break;
+                case 'm': depots[kOrangeMed] = { x, y }; break;
+                default: break;
+                }
+            }
+            // Short rows are padded with open ground
+            std::fill(dst + len, dst + g.w, Tile::Open);
+        }
+    });
+
+    IVec2* targets[4] = { &g.blueAmmo, &g.blueMed, &g.orangeAmmo, &g.orangeMed };
+    for (auto& depots : found)
+        for (int k = 0; k < 4; ++k)
+            if (depots[k].x >= 0) *targets[k] = depots[k];
+    return true;
+}
@@ -0,0 +1,157 @@
+// MapGen.cpp - Seeded procedural maps for load tests
+// Rock clusters, tree lines, lakes and chokepoint walls on open ground,
+// two cleared corner bases with depots, connectivity enforced by flood fill.
+
+#include "MapGen.h"
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    bool inBase(const Grid& g, int x, int y, int b)
+    {
+        return (x < b && y < b) || (x >= g.w - b && y >= g.h - b);
+    }
+
+    void put(Grid& g, int x, int y, Tile t, int b)
+    {
+        if (g.inBounds({ x, y }) && !inBase(g, x, y, b)) g.cells[(std::size_t)y * g.w + x] = t;
+    }
+
+    // Roughly round blob; the outer ring is ragged
+    void blob(Grid& g, std::mt19937& rng, int cx, int cy, int r, Tile t, int b)
+    {
+        for (int dy = -r; dy <= r; ++dy)
+            for (int dx = -r; dx <= r; ++dx) {
+                int d2 = dx * dx + dy * dy;
+                if (d2 > r * r) continue;
+                if (d2 > (r - 1) * (r - 1) && rng() % 2) continue;
+                put(g, cx + dx, cy + dy, t, b);
+            }
+    }
+
+    // Wandering line: straight or diagonal steps, turning now and then
+    void treeLine(Grid& g, std::mt19937& rng, int x, int y, int len, int b)
+    {
+        static const IVec2 dirs[8] = { {1,0},{1,1},{0,1},{-1,1},{-1,0},{-1,-1},{0,-1},{1,-1} };
+        int d = rng() % 8;
+        for (int i = 0; i < len; ++i) {
+            put(g, x, y, Tile::Tree, b);
+            if (rng() % 5 == 0) d = (d + (rng() % 2 ? 1 : 7)) % 8;
+            x += dirs[d].x;
+            y += dirs[d].y;
+        }
+    }
+
+    // Two cells thick, crossing the map, with a few gaps 3 to 5 cells wide
+    void chokeWall(Grid& g, std::mt19937& rng, bool vertical, int at, int b)
+    {
+        int len = vertical ? g.h : g.w;
+        std::vector<char> gap(len, 0);
+        int gaps = 2 + len / 512;
+        for (int k = 0; k < gaps; ++k) {
+            int width = 3 + rng() % 3;
+            int start = rng() % std::max(1, len - width);
+            for (int i = start; i < start + width; ++i) gap[i] = 1;
+        }
+        for (int i = 0; i < len; ++i) {
+            if (gap[i]) continue;
+            for (int t = 0; t < 2; ++t) {
+                if (vertical) put(g, at + t, i, Tile::Rock, b);
+                else put(g, i, at + t, Tile::Rock, b);
+            }
+        }
+    }
+
+    // Scanline flood fill over passable cells
+    std::vector<bool> reachable(const Grid& g, IVec2 seed)
+    {
+        std::vector<bool> reached((std::size_t)g.w * g.h, false);
+        auto open = [&](int x, int y) {
+            std::size_t i = (std::size_t)y * g.w + x;
+            return !reached[i] && g.passable({ x, y });
+        };
+        std::vector<IVec2> stack{ seed };
+        while (!stack.empty()) {
+            IVec2 p = stack.back();
+            stack.pop_back();
+            if (!open(p.x, p.y)) continue;
+            int l = p.x, r = p.x;
+            while (l > 0 && open(l - 1, p.y)) --l;
+            while (r < g.w - 1 && open(r + 1, p.y)) ++r;
+            for (int x = l; x <= r; ++x) reached[(std::size_t)p.y * g.w + x] = true;
+            for (int ny : { p.y - 1, p.y + 1 }) {
+                if (ny < 0 || ny >= g.h) continue;
+                for (int x = l; x <= r; ++x)
+                    if (open(x, ny) && (x == l || !open(x - 1, ny))) stack.push_back({ x, ny });
+            }
+        }
+        return reached;
+    }
+
+    // Three-wide L-shaped corridor through whatever is in the way
+    void carve(Grid& g, IVec2 a, IVec2 b)
+    {
+        auto clear = [&](int x, int y) {
+            for (int d = -1; d <= 1; ++d)
+                for (IVec2 q : { IVec2{ x + d, y }, IVec2{ x, y + d } })
+                    if (g.inBounds(q) && !g.passable(q)) g.cells[(std::size_t)q.y * g.w + q.x] = Tile::Open;
+        };
+        for (int x = std::min(a.x, b.x); x <= std::max(a.x, b.x); ++x) clear(x, a.y);
+        for (int y = std::min(a.y, b.y); y <= std::max(a.y, b.y); ++y) clear(b.x, y);
+    }
+}
+
+int baseSize(const Grid& g)
+{
+    return std::clamp(std::min(g.w, g.h) / 6, 8, 32);
+}
+
+Grid generateMap(const MapGenParams& p)
+{
+    Grid g;
+    g.w = p.w;
+    g.h = p.h;
+    g.cells.assign((std::size_t)g.w * g.h, Tile::Open);
+    std::mt19937 rng(p.seed);
+    const int b = baseSize(g);
+    const double cells = (double)g.w * g.h;
+
+    auto scatter = [&](float density, double meanArea, auto&& place) {
+        long long n = (long long)(density * cells / meanArea);
+        for (long long i = 0; i < n; ++i) place((int)(rng() % g.w), (int)(rng() % g.h));
+    };
+    scatter(p.rockDensity, 3.14 * 17, [&](int x, int y) { blob(g, rng, x, y, 2 + rng() % 5, Tile::Rock, b); });
+    scatter(p.waterDensity, 3.14 * 45, [&](int x, int y) { blob(g, rng, x, y, 3 + rng() % 8, Tile::Water, b); });
+    scatter(p.treeDensity, 24, [&](int x, int y) { treeLine(g, rng, x, y, 8 + rng() % 32, b); });
+
+    // Chokepoints alternate between vertical and horizontal walls, spread
+    // over the middle of the map so neither base is walled in
+    for (int i = 0; i < p.chokepoints; ++i) {
+        bool vertical = i % 2 == 0;
+        int span = vertical ? g.w : g.h;
+        int slot = i / 2 + 1, slots = (p.chokepoints + 1 - i % 2) / 2 + 1;
+        chokeWall(g, rng, vertical, span / 4 + span / 2 * slot / slots, b);
+    }
+
+    // Connect the bases if the obstacles cut them apart, then fill every
+    // pocket Blue cannot reach
+    IVec2 blueHome{ b / 2, b / 2 }, orangeHome{ g.w - 1 - b / 2, g.h - 1 - b / 2 };
+    auto reached = reachable(g, blueHome);
+    if (!reached[(std::size_t)orangeHome.y * g.w + orangeHome.x]) {
+        carve(g, blueHome, orangeHome);
+        reached = reachable(g, blueHome);
+    }
+    for (std::size_t i = 0; i < g.cells.size(); ++i)
+        if (!reached[i] && g.cells[i] != Tile::Rock && g.cells[i] != Tile::Water) g.cells[i] = Tile::Rock;
+
+    g.blueAmmo = { 1, b - 2 };
+    g.blueMed = { b - 2, 1 };
+    g.orangeAmmo = { g.w - 2, g.h - b + 1 };
+    g.orangeMed = { g.w - b + 1, g.h - 2 };
+    for (IVec2 d : { g.blueAmmo, g.orangeAmmo }) g.cells[(std::size_t)d.y * g.w + d.x] = Tile::DepotAmmo;
+    for (IVec2 d : { g.blueMed, g.orangeMed }) g.cells[(std::size_t)d.y * g.w + d.x] = Tile::DepotMed;
+    return g;
+}
@@ -0,0 +1,295 @@
+// Metrics.cpp - Per-thread counter slots, histograms, JSON dumps and the
+// allocation-counting operator new
+// A thread registers its slot on first use; slots outlive their threads so
+// the totals keep what exited pool workers did.
+
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Constant-initialised, so they count from the first allocation on,
+    // before any other static is constructed
+    std::atomic<std::uint64_t> allocCount{ 0 }, allocBytes{ 0 };
+
+    using Cell = std::atomic<std::uint64_t>;
+
+    // Only the owning thread writes a slot, so a relaxed load and store
+    // replace the locked read-modify-write; readers may see it mid-update
+    void bump(Cell& c, std::uint64_t n)
+    {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    struct Slot {
+        struct Hist {
+            Cell buckets[HistogramData::kBuckets];
+            Cell count, sum, max;
+        };
+        Cell counters[(int)Counter::Count];
+        Hist histograms[(int)Histogram::Count];
+    };
+
+    std::atomic<std::int64_t> gauges[(int)Gauge::Count];
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<Slot>> registry;
+
+    Slot& threadSlot()
+    {
+        thread_local Slot* slot = nullptr;
+        if (!slot) {
+            auto fresh = std::make_unique<Slot>();  // value-initialised: all zero
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(std::move(fresh));
+            slot = registry.back().get();
+        }
+        return *slot;
+    }
+
+    int log2Floor(std::uint64_t v)
+    {
+        int e = 0;
+        for (int s = 32; s; s >>= 1)
+            if (v >> s) {
+                v >>= s;
+                e += s;
+            }
+        return e;
+    }
+
+    const char* const kCounterNames[] = {
+        "ticks", "astar_calls", "astar_nodes", "bfs_calls", "bfs_nodes",
+        "jps_calls", "jps_nodes", "hpa_calls", "hpa_nodes", "los_checks", "los_cells",
+        "risk_cells", "log_bytes", "allocations", "allocated_bytes", "shots", "hits", "grenades", "deaths",
+        "revives", "resupplies",
+    };
+    const char* const kGaugeNames[] = { "bullets_alive" };
+    const char* const kHistogramNames[] = {
+        "astar_nodes_per_call", "bfs_nodes_per_call", "jps_nodes_per_call",
+        "hpa_nodes_per_call", "tick_allocations",
+    };
+    static_assert(sizeof(kCounterNames) / sizeof(*kCounterNames) == (int)Counter::Count, "name every counter");
+    static_assert(sizeof(kGaugeNames) / sizeof(*kGaugeNames) == (int)Gauge::Count, "name every gauge");
+    static_assert(sizeof(kHistogramNames) / sizeof(*kHistogramNames) == (int)Histogram::Count, "name every histogram");
+
+    struct Dumper {
+        std::mutex m;
+        std::condition_variable cv;
+        bool stopping{ false };
+        std::thread thread;
+    };
+    std::unique_ptr<Dumper> dumper;
+}
+
+int HistogramData::bucketOf(std::uint64_t v)
+{
+    if (v < (1u << kSubBits)) return (int)v;
+    int e = log2Floor(v);
+    return ((e - kSubBits + 1) << kSubBits) + (int)((v >> (e - kSubBits)) & ((1u << kSubBits) - 1));
+}
+
+std::uint64_t HistogramData::bucketHigh(int b)
+{
+    if (b < (1 << kSubBits)) return (std::uint64_t)b;
+    int e = (b >> kSubBits) + kSubBits - 1;
+    std::uint64_t sub = (std::uint64_t)(b & ((1 << kSubBits) - 1));
+    std::uint64_t low = ((1ull << kSubBits) + sub) << (e - kSubBits);
+    return low + ((1ull << (e - kSubBits)) - 1);
+}
+
+std::uint64_t HistogramData::quantile(double q) const
+{
+    if (!count) return 0;
+    std::uint64_t rank = std::max<std::uint64_t>(1, (std::uint64_t)std::ceil(q * count)), seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+        seen += buckets[b];
+        if (seen >= rank) return std::min(bucketHigh(b), max);
+    }
+    return max;
+}
+
+MetricsSnapshot MetricsSnapshot::since(const MetricsSnapshot& earlier) const
+{
+    MetricsSnapshot d = *this;
+    for (int i = 0; i < (int)Counter::Count; ++i) d.counters[i] -= earlier.counters[i];
+    for (int h = 0; h < (int)Histogram::Count; ++h) {
+        HistogramData& o = d.histograms[h];
+        const HistogramData& e = earlier.histograms[h];
+        for (int b = 0; b < HistogramData::kBuckets; ++b) o.buckets[b] -= e.buckets[b];
+        o.count -= e.count;
+        o.sum -= e.sum;
+    }
+    return d;
+}
+
+namespace metrics
+{
+    void add(Counter c, std::uint64_t n)
+    {
+        bump(threadSlot().counters[(int)c], n);
+    }
+
+    void set(Gauge g, std::int64_t v)
+    {
+        gauges[(int)g].store(v, std::memory_order_relaxed);
+    }
+
+    void record(Histogram h, std::uint64_t v)
+    {
+        Slot::Hist& s = threadSlot().histograms[(int)h];
+        bump(s.buckets[HistogramData::bucketOf(v)], 1);
+        bump(s.count, 1);
+        bump(s.sum, v);
+        if (v > s.max.load(std::memory_order_relaxed)) s.max.store(v, std::memory_order_relaxed);
+    }
+
+    std::uint64_t allocations()
+    {
+        return allocCount.load(std::memory_order_relaxed);
+    }
+
+    void read(MetricsSnapshot& out)
+    {
+        out = MetricsSnapshot{};
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (auto& slot : registry) {
+                for (int i = 0; i < (int)Counter::Count; ++i)
+                    out.counters[i] += slot->counters[i].load(std::memory_order_relaxed);
+                for (int h = 0; h < (int)Histogram::Count; ++h) {
+                    const Slot::Hist& s = slot->histograms[h];
+                    HistogramData& o = out.histograms[h];
+                    for (int b = 0; b < HistogramData::kBuckets; ++b) o.buckets[b] += s.buckets[b].load(std::memory_order_relaxed);
+                    o.count += s.count.load(std::memory_order_relaxed);
+                    o.sum += s.sum.load(std::memory_order_relaxed);
+                    o.max = std::max(o.max, s.max.load(std::memory_order_relaxed));
+                }
+            }
+        }
+        out.counters[(int)Counter::Allocations] += allocCount.load(std::memory_order_relaxed);
+        out.counters[(int)Counter::AllocatedBytes] += allocBytes.load(std::memory_order_relaxed);
+        for (int g = 0; g < (int)Gauge::Count; ++g) out.gauges[g] = gauges[g].load(std::memory_order_relaxed);
+    }
+
+    const char* name(Counter c) { return kCounterNames[(int)c]; }
+    const char* name(Gauge g) { return kGaugeNames[(int)g]; }
+    const char* name(Histogram h) { return kHistogramNames[(int)h]; }
+
+    void writeJson(std::ostream& os, const MetricsSnapshot& s, double ms)
+    {
+        os << "{\"ms\":" << (std::uint64_t)ms << ",\"counters\":{";
+        for (int i = 0; i < (int)Counter::Count; ++i)
+            os << (i ? "," : "") << '"' << kCounterNames[i] << "\":" << s.counters[i];
+        os << "},\"gauges\":{";
+        for (int g = 0; g < (int)Gauge::Count; ++g)
+            os << (g ? "," : "") << '"' << kGaugeNames[g] << "\":" << s.gauges[g];
+        os << "},\"histograms\":{";
+        for (int h = 0; h < (int)Histogram::Count; ++h) {
+            const HistogramData& d = s.histograms[h];
+            os << (h ? "," : "") << '"' << kHistogramNames[h] << "\":{\"count\":" << d.count
+               << ",\"mean\":" << std::round(d.mean() * 100) / 100 << ",\"p50\":" << d.quantile(0.5)
+               << ",\"p99\":" << d.quantile(0.99) << ",\"max\":" << d.max << '}';
+        }
+        os << "}}\n";
+    }
+
+    bool startDump(const std::string& path, int intervalMs, std::string& error)
+    {
+        stopDump();
+        auto out = std::make_shared<std::ofstream>(path, std::ios::binary | std::ios::trunc);
+        if (!out->is_open()) {
+            error = "Cannot write " + path;
+            return false;
+        }
+        dumper = std::make_unique<Dumper>();
+        Dumper* d = dumper.get();
+        d->thread = std::thread([d, out, intervalMs] {
+            using clock = std::chrono::steady_clock;
+            const auto start = clock::now();
+            MetricsSnapshot s;
+            bool last = false;
+            while (!last) {
+                {
+                    std::unique_lock<std::mutex> lock(d->m);
+                    last = d->cv.wait_for(lock, std::chrono::milliseconds(intervalMs), [d] { return d->stopping; });
+                }
+                read(s);
+                writeJson(*out, s, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+                out->flush();
+            }
+        });
+        return true;
+    }
+
+    void stopDump()
+    {
+        if (!dumper) return;
+        {
+            std::lock_guard<std::mutex> lock(dumper->m);
+            dumper->stopping = true;
+        }
+        dumper->cv.notify_all();
+        dumper->thread.join();
+        dumper.reset();
+    }
+}
+
+// Every global allocation is counted. Over-aligned new keeps the library's
+// own operators and is not counted.
+void* operator new(std::size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+    for (;;) {
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return ::operator new(size); }
+    catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return ::operator new(size); }
+    catch (...) { return nullptr; }
+}
+
+// Once this is inlined GCC sees memory from operator new passed to free()
+// and warns, although the operator new above is malloc underneath
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+void operator delete[](void* p) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
@@ -0,0 +1,136 @@
+// PathService.cpp - Batched, deduplicated path solving
+// Identical queries issued in the same tick (e.g. medic and porter both
+// heading home) are solved once, and unique queries run on the task pool.
+
+#include "PathService.h"
+#include "AStar.h"
+#include "JPS.h"
+#include "TaskPool.h"
+#include "RadixHeap.h"
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+std::size_t PathService::KeyHash::operator()(const PathRequest& r) const
+{
+    std::uint32_t alphaBits;
+    std::memcpy(&alphaBits, &r.alpha, sizeof alphaBits);
+
+    std::size_t h = std::hash<const void*>()(r.riskLayer);
+    auto mix = [&](std::uint64_t v) { h ^= std::size_t(v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2)); };
+    mix(std::uint32_t(r.start.x) | (std::uint64_t(std::uint32_t(r.start.y)) << 32));
+    mix(std::uint32_t(r.goal.x) | (std::uint64_t(std::uint32_t(r.goal.y)) << 32));
+    mix(alphaBits);
+    return h;
+}
+
+void PathService::reserve(std::size_t requests, std::size_t pathCells)
+{
+    std::lock_guard<std::mutex> lock(m);
+    unique.reserve(requests);
+    waiting.reserve(requests);
+    lookup.reserve(requests);
+    if (results.size() < requests) results.resize(requests);
+    for (auto& path : results) path.reserve(pathCells);
+}
+
+void PathService::request(const PathRequest& r, Callback onDone)
+{
+    std::lock_guard<std::mutex> lock(m);
+    st.requests++;
+
+    auto it = lookup.find(r);
+    int slot;
+    if (it != lookup.end()) {
+        slot = it->second;
+        st.dedupHits++;
+    } else {
+        slot = (int)unique.size();
+        unique.push_back(r);
+        lookup.emplace(r, slot);
+    }
+    waiting.emplace_back(slot, std::move(onDone));
+}
+
+void PathService::flush(const Grid& g, std::pmr::memory_resource* scratch)
+{
+    st.lastQueueDepth = waiting.size();
+    if (st.lastQueueDepth > st.maxQueueDepth) st.maxQueueDepth = st.lastQueueDepth;
+    if (waiting.empty()) return;
+
+    // Never shrink: dropping the trailing paths would free their storage
+    if (results.size() < unique.size()) results.resize(unique.size());
+    std::pmr::vector<long long> micros(unique.size(), scratch);
+
+    // Long queries on big maps go through HPA*. Its edge costs follow one
+    // risk layer (the team's); requests on other layers stay flat.
+    std::pmr::vector<char> useHpa(unique.size(), 0, scratch);
+    const RiskMap* hpaLayer = nullptr;
+    if (g.hpa) {
+        for (size_t i = 0; i < unique.size(); ++i) {
+            const PathRequest& r = unique[i];
+            if (r.start.manhattan(r.goal) < kHpaMinDistance) continue;
+            if (!hpaLayer) hpaLayer = r.riskLayer;
+            useHpa[i] = (r.riskLayer == hpaLayer);
+        }
+        if (hpaLayer) hpaCosts.refresh(g, *g.hpa, *hpaLayer);
+    }
+
+    // Where every step costs the same (alpha 0, or flat risk over the box
+    // around start and goal) jump point search replaces A*. Inside the box
+    // its path is optimal. A route that leaves the box walks at least
+    // 2 * (kJpsMargin + 1) extra steps, each costing at least 1, so the JPS
+    // path is kept only if it is no dearer than that; otherwise, or if the
+    // box cuts the goal off, A* takes over.
+    std::pmr::vector<char> usedJps(unique.size(), 0, scratch);
+    auto solveFlat = [&](int i, std::vector<IVec2>& path) {
+        const PathRequest& r = unique[i];
+        if (kUseJps) {
+            IVec2 lo{ 0, 0 }, hi{ g.w - 1, g.h - 1 };
+            if (r.alpha != 0.f) {
+                lo = { std::max(0, std::min(r.start.x, r.goal.x) - kJpsMargin),
+                       std::max(0, std::min(r.start.y, r.goal.y) - kJpsMargin) };
+                hi = { std::min(g.w - 1, std::max(r.start.x, r.goal.x) + kJpsMargin),
+                       std::min(g.h - 1, std::max(r.start.y, r.goal.y) + kJpsMargin) };
+            }
+            if (r.alpha == 0.f || riskFlat(g, *r.riskLayer, lo, hi)) {
+                jpsPath(g, r.start, r.goal, lo, hi, path);
+                bool wholeMap = lo == IVec2{ 0, 0 } && hi == IVec2{ g.w - 1, g.h - 1 };
+                std::uint64_t step = quantCost(1.0f + r.alpha * riskAt(*r.riskLayer, g, r.goal));
+                std::uint64_t outside = std::uint64_t(r.start.manhattan(r.goal) + 2 * (kJpsMargin + 1)) * quantCost(1.0f);
+                if (path.back() == r.goal && (wholeMap || (path.size() - 1) * step <= outside)) {
+                    usedJps[i] = 1;
+                    return;
+                }
+            }
+        }
+        aStarPath(g, r.start, r.goal, *r.riskLayer, r.alpha, path);
+    };
+
+    TaskPool::shared().parallelFor((int)unique.size(), [&](int i) {
+        auto t0 = std::chrono::steady_clock::now();
+        const PathRequest& r = unique[i];
+        if (useHpa[i])
+            results[i] = hpaPath(g, *g.hpa, hpaCosts, r.start, r.goal, *r.riskLayer, r.alpha);
+        else
+            solveFlat(i, results[i]);
+        auto t1 = std::chrono::steady_clock::now();
+        micros[i] = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    });
+
+    for (long long us : micros) {
+        std::size_t bucket = 0;
+        while (us > 1 && bucket + 1 < st.solveMicros.size()) { us >>= 1; bucket++; }
+        st.solveMicros[bucket]++;
+    }
+    st.solved += unique.size();
+    for (char h : useHpa) st.hierarchical += h;
+    for (char j : usedJps) st.jumpPoint += j;
+
+    for (auto& [slot, cb] : waiting)
+        cb(results[slot]);
+
+    unique.clear();
+    lookup.clear();
+    waiting.clear();
+}
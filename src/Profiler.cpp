@@ -0,0 +1,162 @@
+// Profiler.cpp - Per-thread zone buffers, Chrome trace export and summary
+// A thread registers its buffer on its first zone; buffers outlive their
+// threads so pool workers that have exited still show up in the trace.
+
+#include "Profiler.h"
+#include "Types.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+    struct Event {
+        const char* name;
+        std::int64_t start, end;
+    };
+
+    struct ThreadBuffer {
+        int tid;
+        std::vector<Event> events;
+        std::size_t dropped{ 0 };
+    };
+
+    const auto kEpoch = std::chrono::steady_clock::now();
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+    ThreadBuffer& threadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(std::make_unique<ThreadBuffer>());
+            buffer = registry.back().get();
+            buffer->tid = (int)registry.size();
+            buffer->events.reserve(1 << 12);
+        }
+        return *buffer;
+    }
+
+    // JSON string contents; zone names are plain literals, but be safe
+    void writeEscaped(std::FILE* f, const char* s)
+    {
+        for (; *s; ++s) {
+            if (*s == '"' || *s == '\\') std::fputc('\\', f);
+            std::fputc(*s, f);
+        }
+    }
+}
+
+namespace profiler
+{
+    std::int64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kEpoch).count();
+    }
+
+    void record(const char* name, std::int64_t startNs, std::int64_t endNs)
+    {
+        ThreadBuffer& b = threadBuffer();
+        if (b.events.size() >= (std::size_t)kProfileMaxEvents) {
+            b.dropped++;
+            return;
+        }
+        b.events.push_back({ name, startNs, endNs });
+    }
+
+    std::size_t eventCount()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::size_t n = 0;
+        for (auto& b : registry) n += b->events.size();
+        return n;
+    }
+
+    bool writeChromeTrace(const std::string& path, std::string& error)
+    {
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) {
+            error = "Cannot write " + path;
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+        bool first = true;
+        for (auto& b : registry) {
+            std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                first ? "" : ",\n", b->tid, b->tid);
+            first = false;
+            for (const Event& e : b->events) {
+                std::fputs(",\n{\"name\":\"", f);
+                writeEscaped(f, e.name);
+                std::fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    b->tid, e.start / 1000.0, (e.end - e.start) / 1000.0);
+            }
+        }
+        std::fputs("\n]}\n", f);
+        if (std::fclose(f) != 0) {
+            error = "Writing " + path + " failed";
+            return false;
+        }
+        return true;
+    }
+
+    void printSummary(std::ostream& os)
+    {
+        std::map<std::string, std::vector<std::int64_t>> zones;
+        std::size_t dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (auto& b : registry) {
+                dropped += b->dropped;
+                for (const Event& e : b->events) zones[e.name].push_back(e.end - e.start);
+            }
+        }
+
+        struct Row {
+            const std::string* name;
+            std::size_t calls;
+            double total, p50, p99, max;
+        };
+        std::vector<Row> rows;
+        for (auto& [name, d] : zones) {
+            std::sort(d.begin(), d.end());
+            double total = 0;
+            for (auto ns : d) total += ns;
+            // Nearest rank
+            auto at = [&](double q) { return d[std::max<std::size_t>(1, (std::size_t)std::ceil(q * d.size())) - 1] / 1000.0; };
+            rows.push_back({ &name, d.size(), total / 1e6, at(0.5), at(0.99), d.back() / 1000.0 });
+        }
+        std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.total > b.total; });
+
+        os << "\n=== Profile (zones nest, so totals overlap) ===\n"
+           << std::left << std::setw(22) << "zone" << std::right
+           << std::setw(9) << "calls" << std::setw(11) << "total ms" << std::setw(10) << "mean us"
+           << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "max us" << '\n'
+           << std::fixed << std::setprecision(1);
+        for (const Row& r : rows)
+            os << std::left << std::setw(22) << *r.name << std::right << std::setw(9) << r.calls
+               << std::setw(11) << r.total << std::setw(10) << r.total * 1000.0 / r.calls
+               << std::setw(10) << r.p50 << std::setw(10) << r.p99 << std::setw(10) << r.max << '\n';
+        if (dropped) os << dropped << " zones dropped (over kProfileMaxEvents per thread)\n";
+        os << std::defaultfloat;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& b : registry) {
+            b->events.clear();
+            b->dropped = 0;
+        }
+    }
+}
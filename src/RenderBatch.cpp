@@ -0,0 +1,221 @@
+// RenderBatch.cpp - GL-free half of the renderer
+// Terrain colours and the per-frame quad list for everything that moves,
+// built from render snapshots rather than the live game.
+
+#include "RenderBatch.h"
+#include "Snapshot.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+
+Rgba8 tileColor(Tile t)
+{
+    switch (t) {
+    case Tile::Rock:       return rgb(0.5f, 0.5f, 0.5f);
+    case Tile::Tree:       return rgb(0.1f, 0.5f, 0.1f);
+    case Tile::Water:      return rgb(0.1f, 0.3f, 0.8f);
+    case Tile::DepotAmmo:  return rgb(0.9f, 0.9f, 0.2f);
+    case Tile::DepotMed:   return rgb(0.9f, 0.9f, 0.2f);
+    default:               return rgb(0.92f, 1.0f, 0.92f);
+    }
+}
+
+void QuadBatch::text(float x, float y, float scale, const char* s, Rgba8 c)
+{
+    for (; *s; ++s, x += kFontAdvance * scale) {
+        if (*s == ' ') continue;
+        float u0, v0, u1, v1;
+        FontAtlas::uv(*s, u0, v0, u1, v1);
+        float w = kFontW * scale, h = kFontH * scale;
+        verts.push_back({ x, y, u0, v0, c });
+        verts.push_back({ x + w, y, u1, v0, c });
+        verts.push_back({ x + w, y + h, u1, v1, c });
+        verts.push_back({ x, y + h, u0, v1, c });
+    }
+}
+
+void terrainPixels(const Grid& g, int x0, int y0, int w, int h, std::vector<Rgba8>& out)
+{
+    out.resize((std::size_t)w * h);
+    for (int y = 0; y < h; ++y) {
+        const Tile* row = &g.cells[(std::size_t)(y0 + y) * g.w + x0];
+        Rgba8* dst = &out[(std::size_t)y * w];
+        for (int x = 0; x < w; ++x) dst[x] = tileColor(row[x]);
+    }
+}
+
+void PixelMask::begin(const ViewRect& view)
+{
+    for (std::size_t i : touched) bits[i] = 0;
+    touched.clear();
+    // A quad is at most a cell wide, so one pixel of margin left and above
+    ox = (std::int64_t)std::floor(view.x0 / view.pixel) - 1;
+    oy = (std::int64_t)std::floor(view.y0 / view.pixel) - 1;
+    w = (std::int64_t)std::floor(view.x1 / view.pixel) - ox + 1;
+    h = (std::int64_t)std::floor(view.y1 / view.pixel) - oy + 1;
+    std::size_t words = (std::size_t)((w * h + 63) / 64);
+    if (bits.size() < words) bits.resize(words, 0);
+}
+
+bool PixelMask::claim(std::int64_t px, std::int64_t py)
+{
+    px -= ox;
+    py -= oy;
+    if (px < 0 || py < 0 || px >= w || py >= h) return true;
+    std::size_t i = (std::size_t)(py * w + px);
+    std::uint64_t& word = bits[i >> 6];
+    const std::uint64_t bit = std::uint64_t(1) << (i & 63);
+    if (word & bit) return false;
+    if (!word) touched.push_back(i >> 6);
+    word |= bit;
+    return true;
+}
+
+namespace
+{
+    Rgba8 agentColor(const SnapAgent& a)
+    {
+        if (a.incapacitated) return rgb(0.8f, 0.2f, 0.2f); // needs revival!
+        bool blue = a.team == Team::Blue;
+        switch (a.role) {
+        case Role::Commander: return blue ? rgb(0.1f, 0.3f, 1.0f) : rgb(1.0f, 0.4f, 0.0f);
+        case Role::Warrior:   return blue ? rgb(0.3f, 0.5f, 1.0f) : rgb(1.0f, 0.6f, 0.1f);
+        default:              return blue ? rgb(0.1f, 0.6f, 1.0f) : rgb(1.0f, 0.7f, 0.2f);
+        }
+    }
+}
+
+void batchDynamic(const RenderSnapshot& prev, const RenderSnapshot& cur, float alpha, QuadBatch& batch,
+                  PixelMask& taken, const ViewRect& view, std::vector<AgentLabel>* labelled)
+{
+    // Zoomed out past one cell per pixel: snap to whole pixels, first quad wins
+    const bool lod = view.pixel > 1.0f;
+    if (lod) taken.begin(view);
+    auto emit = [&](float x, float y, float size, Rgba8 c) {
+        if (!view.overlaps(x, y, size, size)) return false;
+        if (lod) {
+            std::int64_t px = (std::int64_t)std::floor(x / view.pixel), py = (std::int64_t)std::floor(y / view.pixel);
+            if (!taken.claim(px, py)) return false;
+            x = px * view.pixel;
+            y = py * view.pixel;
+            size = view.pixel;
+        }
+        batch.quad(x, y, size, size, c);
+        return true;
+    };
+
+    const bool matched = prev.agents.size() == cur.agents.size();
+    for (std::size_t i = 0; i < cur.agents.size(); ++i) {
+        const SnapAgent& a = cur.agents[i];
+        if (!a.alive) continue;
+        float x = a.x, y = a.y;
+        if (matched && prev.agents[i].alive) {
+            x = prev.agents[i].x + (a.x - prev.agents[i].x) * alpha;
+            y = prev.agents[i].y + (a.y - prev.agents[i].y) * alpha;
+        }
+        if (emit(x, y, 1.0f, agentColor(a)) && labelled) labelled->push_back({ x, y, a.glyph, a.hp });
+    }
+
+    // Bullets and grenades
+    const float size = 0.3f;
+    for (const auto& b : cur.bullets)
+        emit(b.x - size * 0.5f, b.y - size * 0.5f, size, rgb(1.0f, 1.0f, 0.0f));
+    for (const auto& t : cur.trails)
+        emit(t.x, t.y, 0.15f, rgb(1.0f, 0.6f, 0.0f));
+    for (const auto& g : cur.grenades)
+        emit(g.x, g.y, 0.4f, rgb(1.0f, 0.3f, 0.0f));
+}
+
+float labelScale(const ViewRect& view)
+{
+    if (view.pixel <= 0) return 0.1f;
+    if (view.pixel * kLabelMinPixels > 1.0f) return 0;
+    return view.pixel * std::floor(1.0f / (view.pixel * kLabelMinPixels));
+}
+
+void batchLabels(QuadBatch& batch, const std::vector<AgentLabel>& labels, float scale)
+{
+    const Rgba8 ink = rgb(0, 0, 0);
+    for (const AgentLabel& a : labels) {
+        char glyph[2] = { a.glyph, '\0' };
+        batch.text(a.x + 0.5f - kFontW * scale * 0.5f, a.y + 0.5f - kFontH * scale * 0.5f, scale, glyph, ink);
+        TextLine hp;
+        hp << a.hp;
+        float width = (hp.len * kFontAdvance - 1) * scale;
+        batch.text(a.x + 0.5f - width * 0.5f, a.y + 1.0f + scale, scale, hp.text, ink);
+    }
+}
+
+void batchHud(QuadBatch& batch, const RenderSnapshot& snap, const HudStats& stats, int width, int height)
+{
+    const float px = 2;                         // screen pixels per font pixel
+    const float line = kFontLine * px, margin = 6;
+
+    TextLine lines[8];
+    int count = 3;
+    lines[0] << "TICK " << snap.tick << "  STEP ";
+    lines[0].fixed(snap.tickMs, 2) << " MS  ";
+    lines[0].fixed(stats.fps, 0) << " FPS  ";
+    if (stats.unlimited) lines[0] << "MAX SPEED";
+    else if (stats.speed <= 0) lines[0] << "PAUSED";
+    else lines[0].fixed(stats.speed, stats.speed < 1 ? 3 : 0) << 'X';
+
+    for (int t = 0; t < 2; ++t) {
+        Team team = t == 0 ? Team::Blue : Team::Orange;
+        int warriors = 0, up = 0, down = 0, hp = 0;
+        bool commander = false;
+        for (const SnapAgent& a : snap.agents) {
+            if (a.team != team) continue;
+            if (a.role == Role::Commander) commander = a.alive;
+            if (a.role != Role::Warrior) continue;
+            warriors++;
+            if (a.alive && !a.incapacitated) up++;
+            if (a.alive && a.incapacitated) down++;
+            if (a.alive) hp += a.hp;
+        }
+        lines[1 + t] << (t == 0 ? "BLUE    " : "ORANGE  ") << "CMDR " << (commander ? "OK" : "KIA")
+                     << "  WARRIORS " << up << '/' << warriors << "  DOWN " << down << "  HP " << hp;
+    }
+
+    if (const MetricsSnapshot* m = stats.metrics; m && (*m)[Counter::Ticks] > 0) {
+        const double ticks = (double)(*m)[Counter::Ticks];
+        auto perTick = [&](Counter c) { return (*m)[c] / ticks; };
+        auto quantiles = [](TextLine& l, const HistogramData& h) {
+            l.fixed((double)h.quantile(0.5), 0) << " P99 ";
+            l.fixed((double)h.quantile(0.99), 0);
+        };
+        TextLine* l = &lines[count];
+        l[0] << "A*    CALLS/TICK ";
+        l[0].fixed(perTick(Counter::AStarCalls), 1) << "  NODES P50 ";
+        quantiles(l[0], (*m)[Histogram::AStarNodes]);
+        l[1] << "BFS   CALLS/TICK ";
+        l[1].fixed(perTick(Counter::BfsCalls), 1) << "  NODES P50 ";
+        quantiles(l[1], (*m)[Histogram::BfsNodes]);
+        l[2] << "LOS   CHECKS/TICK ";
+        l[2].fixed(perTick(Counter::LosChecks), 0) << "  CELLS/CHECK ";
+        l[2].fixed((*m)[Counter::LosChecks] ? (double)(*m)[Counter::LosCells] / (*m)[Counter::LosChecks] : 0.0, 1);
+        l[3] << "RISK  CELLS/TICK ";
+        l[3].fixed(perTick(Counter::RiskCells), 0) << "  BULLETS " << (int)(*m)[Gauge::BulletsAlive] << "  LOG ";
+        l[3].fixed(perTick(Counter::LogBytes), 0) << " B/TICK";
+        l[4] << "ALLOC P50 ";
+        quantiles(l[4], (*m)[Histogram::TickAllocations]);
+        l[4] << "  KB/TICK ";
+        l[4].fixed(perTick(Counter::AllocatedBytes) / 1024.0, 1);
+        count += 5;
+    }
+
+    int longest = 0;
+    for (int i = 0; i < count; ++i) longest = std::max(longest, lines[i].len);
+    batch.quad(0, 0, margin * 2 + (longest * kFontAdvance - 1) * px, margin * 2 + count * line - px, Rgba8{ 0, 0, 0, 160 });
+    const Rgba8 colors[3] = { rgb(1, 1, 1), rgb(0.5f, 0.7f, 1.0f), rgb(1.0f, 0.7f, 0.3f) };
+    for (int i = 0; i < count; ++i)
+        batch.text(margin, margin + i * line, px, lines[i].text, i < 3 ? colors[i] : rgb(0.75f, 0.75f, 0.75f));
+
+    if (!snap.running) {
+        const char* msg = "GAME OVER";
+        const float big = 8;
+        batch.quad(0, 0, (float)width, (float)height, Rgba8{ 0, 0, 0, 128 });
+        float w = (9 * kFontAdvance - 1) * big;
+        batch.text((width - w) * 0.5f, (height - kFontH * big) * 0.5f, big, msg, rgb(1, 1, 1));
+    }
+}
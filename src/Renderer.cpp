@@ -3,190 +3,238 @@
 #include "../Graphics/include/freeglut.h"
 
 #include "Renderer.h"
+#include "RenderBatch.h"
+#include "SimThread.h"
 #include "Camera.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cstddef>
 #include <chrono>
 #include <thread>
 #include <string>
 #include <iostream>
 
+// Only the (immutable) grid is read here: the simulation thread owns the
+// rest of the game and the renderer sees it through snapshots
 static Game* gptr = nullptr;
+static SimThread* sim = nullptr;
+static RenderSnapshot prevSnap;     // the tick shown before the newest one
 static Camera cam;
 
 static bool dragging = false;
 static int lastX = 0, lastY = 0;
 
+// Terrain never changes during a game: it lives in textures uploaded once,
+// one texel per cell, and costs one quad per visible page however big the
+// map is. Mipmaps supply the terrain when zoomed out below a texel per pixel.
+struct TerrainPage {
+    GLuint tex;
+    int x, y, w, h;
+};
+static std::vector<TerrainPage> terrain;
+
+// Everything that moves is rebuilt into one quad list per frame, streamed
+// into a vertex buffer and drawn with a single call
+static QuadBatch batch;
+static std::vector<AgentLabel> labelled;
+static PixelMask taken;
+static QuadBatch hud;
+static GLuint streamVbo = 0;
+static GLuint fontTex = 0;
+
+// The metrics overlay ('m') shows the counters' growth over the last
+// kMetricsIntervalMs in which the game advanced
+static bool showMetrics = false;
+static MetricsSnapshot metricsMark, metricsWindow;
+
 static void applyCamera() {
     glScalef(cam.zoom, cam.zoom, 1.0f);
     glTranslatef(-cam.x, -cam.y, 0.0f);
 }
 
-static void drawQuad(float x, float y, float w, float h, float r, float g, float b) {
-    glColor3f(r, g, b);
-    glBegin(GL_QUADS);
-    glVertex2f(x, y);
-    glVertex2f(x + w, y);
-    glVertex2f(x + w, y + h);
-    glVertex2f(x, y + h);
-    glEnd();
+// The projection spans the whole map at zoom 1 (see runGraphics)
+static ViewRect visibleView(const Grid& g) {
+    ViewRect v;
+    cam.visibleRect((float)g.w, (float)g.h, v.x0, v.y0, v.x1, v.y1);
+    GLint vp[4];
+    glGetIntegerv(GL_VIEWPORT, vp);
+    if (vp[2] > 0 && vp[3] > 0)
+        v.pixel = std::max((v.x1 - v.x0) / vp[2], (v.y1 - v.y0) / vp[3]);
+    return v;
 }
 
-static void drawText(float x, float y, const std::string& s) {
-    glColor3f(0, 0, 0);
-    glRasterPos2f(x, y);
-    for (unsigned char c : s)
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, c);
+// Glyph ink as alpha under white, so text takes its vertex colour
+static void uploadFont() {
+    FontAtlas atlas;
+    std::vector<Rgba8> pixels(atlas.alpha.size());
+    for (std::size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = Rgba8{ 255, 255, 255, atlas.alpha[i] };
+    glGenTextures(1, &fontTex);
+    glBindTexture(GL_TEXTURE_2D, fontTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, FontAtlas::kWidth, FontAtlas::kHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-static void display() {
-    if (!gptr) return;
-
-    auto& game = *gptr;
-
-    glClearColor(0.85f, 1.0f, 0.85f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    applyCamera();
-
-    float cw = 1.0f;
-    float ch = 1.0f;
-
-    // Draw map
-    for (int y = 0; y < game.grid.h; ++y) {
-        for (int x = 0; x < game.grid.w; ++x) {
-            auto t = game.grid.cells[y * game.grid.w + x];
-            float X = x * cw;
-            float Y = y * ch;
-
-            switch (t) {
-            case Tile::Rock:       drawQuad(X, Y, cw, ch, 0.5, 0.5, 0.5); break;
-            case Tile::Tree:       drawQuad(X, Y, cw, ch, 0.1, 0.5, 0.1); break;
-            case Tile::Water:      drawQuad(X, Y, cw, ch, 0.1, 0.3, 0.8); break;
-            case Tile::DepotAmmo:  drawQuad(X, Y, cw, ch, 0.9, 0.9, 0.2); break;
-            case Tile::DepotMed:   drawQuad(X, Y, cw, ch, 0.9, 0.9, 0.2); break;
-            default:               drawQuad(X, Y, cw, ch, 0.92, 1.0, 0.92);
-            }
+static void uploadTerrain(const Grid& g) {
+    GLint maxTex = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTex);
+    int page = std::min(kTerrainPage, (int)maxTex);
+
+    std::vector<Rgba8> pixels;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (int y = 0; y < g.h; y += page) {
+        for (int x = 0; x < g.w; x += page) {
+            TerrainPage p{ 0, x, y, std::min(page, g.w - x), std::min(page, g.h - y) };
+            terrainPixels(g, p.x, p.y, p.w, p.h, pixels);
+            glGenTextures(1, &p.tex);
+            glBindTexture(GL_TEXTURE_2D, p.tex);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, p.w, p.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            glGenerateMipmap(GL_TEXTURE_2D);
+            terrain.push_back(p);
         }
     }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    // Draw agents
-    auto drawA = [&](const Agent& a, float r, float g, float b) {
-        if (!a.alive) return;
-
-        float X = a.pos.x;
-        float Y = a.pos.y;
-
-        if (X < 0 || Y < 0 || X >= game.grid.w || Y >= game.grid.h) return;
-
-        drawQuad(X, Y, cw, ch, r, g, b);
-        drawText(X + 0.3f, Y + 0.6f, std::string(1, a.glyph));
-        drawText(X + 0.1f, Y + 1.05f, std::to_string(a.hp));
-        };
-
-    // Blue team - show alive in color, dead in gray
-    try {
-        if (game.blue.commander.alive)
-            drawA(game.blue.commander, 0.1f, 0.3f, 1.0f);
-        else
-            drawA(game.blue.commander, 0.4f, 0.4f, 0.4f); // Dead = gray
-
-        for (auto& w : game.blue.warriors)
-            if (!w.alive) 
-                drawA(w, 0.4f, 0.4f, 0.4f); // Dead = gray
-            else if (w.incapacitated)
-                drawA(w, 0.8f, 0.2f, 0.2f); // Incapacitated = red (needs revival!)
-            else
-                drawA(w, 0.3f, 0.5f, 1.0f); // Alive = blue
-
-        if (game.blue.medic.alive)
-            drawA(game.blue.medic, 0.1f, 0.6f, 1.0f);
-        else
-            drawA(game.blue.medic, 0.4f, 0.4f, 0.4f); // Dead = gray
-
-        if (game.blue.porter.alive)
-            drawA(game.blue.porter, 0.1f, 0.6f, 1.0f);
-        else
-            drawA(game.blue.porter, 0.4f, 0.4f, 0.4f); // Dead = gray
-    }
-    catch (...) {}
-
-    // Orange team - show alive in color, dead in gray
-    try {
-        if (game.orange.commander.alive)
-            drawA(game.orange.commander, 1.0f, 0.4f, 0.0f);
-        else
-            drawA(game.orange.commander, 0.4f, 0.4f, 0.4f); // Dead = gray
-
-        for (auto& w : game.orange.warriors)
-            if (!w.alive) 
-                drawA(w, 0.4f, 0.4f, 0.4f); // Dead = gray
-            else if (w.incapacitated)
-                drawA(w, 0.8f, 0.2f, 0.2f); // Incapacitated = red (needs revival!)
-            else
-                drawA(w, 1.0f, 0.6f, 0.1f); // Alive = orange
-
-        if (game.orange.medic.alive)
-            drawA(game.orange.medic, 1.0f, 0.7f, 0.2f);
-        else
-            drawA(game.orange.medic, 0.4f, 0.4f, 0.4f); // Dead = gray
-
-        if (game.orange.porter.alive)
-            drawA(game.orange.porter, 1.0f, 0.7f, 0.2f);
-        else
-            drawA(game.orange.porter, 0.4f, 0.4f, 0.4f); // Dead = gray
+static void drawTerrain(const ViewRect& view) {
+    glEnable(GL_TEXTURE_2D);
+    glColor3f(1, 1, 1);
+    for (auto& p : terrain) {
+        if (!view.overlaps(p.x, p.y, p.w, p.h)) continue;
+        glBindTexture(GL_TEXTURE_2D, p.tex);
+        glBegin(GL_QUADS);
+        glTexCoord2f(0, 0); glVertex2f(p.x, p.y);
+        glTexCoord2f(1, 0); glVertex2f(p.x + p.w, p.y);
+        glTexCoord2f(1, 1); glVertex2f(p.x + p.w, p.y + p.h);
+        glTexCoord2f(0, 1); glVertex2f(p.x, p.y + p.h);
+        glEnd();
     }
-    catch (...) {}
-
-    // Bullets and grenades
-    try {
-        for (const auto& b : game.bullets.bullets)
-        {
-            if (!b.alive) continue;
-            float size = 0.3f;
-            drawQuad(b.x - size * 0.5f, b.y - size * 0.5f, size, size, 1.0f, 1.0f, 0.0f);
-        }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+}
 
-        for (const auto& b : game.bullets.bullets)
-        {
-            for (const auto& t : b.trail)
-            {
-                float alpha = t.life;
-                glColor3f(1.0f * alpha, 0.8f * alpha, 0.0f);
-                drawQuad(t.x, t.y, 0.15f, 0.15f, 1, 0.6, 0.0);
-            }
-        }
+static void drawBatch(const QuadBatch& q) {
+    if (q.verts.empty()) return;
+    GLsizeiptr bytes = q.verts.size() * sizeof(QuadBatch::Vertex);
+    glBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+    // Orphan last frame's storage so the driver never waits on it
+    glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, q.verts.data());
+
+    // Every quad samples the font atlas (plain ones its solid cell), so
+    // text and shapes go out in the same draw
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, fontTex);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(QuadBatch::Vertex), (const void*)offsetof(QuadBatch::Vertex, x));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(QuadBatch::Vertex), (const void*)offsetof(QuadBatch::Vertex, u));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(QuadBatch::Vertex), (const void*)offsetof(QuadBatch::Vertex, c));
+    glDrawArrays(GL_QUADS, 0, (GLsizei)q.verts.size());
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisable(GL_BLEND);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+}
 
-        for (const auto& g : game.grenades.grenades)
-        {
-            glColor3f(1.0, 0.3, 0.0);
-            drawQuad(g.x, g.y, 0.4f, 0.4f, 1, 0.3, 0.0);
-        }
+// Smoothed over recent frames so the HUD stays readable
+static float frameRate() {
+    using clock = std::chrono::steady_clock;
+    static clock::time_point last;
+    static float interval = 0;
+    auto t = clock::now();
+    if (last != clock::time_point()) {
+        float dt = std::chrono::duration<float>(t - last).count();
+        interval = interval > 0 ? interval * 0.9f + dt * 0.1f : dt;
     }
-    catch (...) {}
+    last = t;
+    return interval > 0 ? 1.0f / interval : 0.0f;
+}
 
-    // Game over overlay
-    if (!game.running) {
-        glColor4f(0.0f, 0.0f, 0.0f, 0.5f);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+static const MetricsSnapshot* metricsOverlay() {
+    using clock = std::chrono::steady_clock;
+    static clock::time_point marked;
+    if (!showMetrics) return nullptr;
+    auto t = clock::now();
+    if (t - marked >= std::chrono::milliseconds(kMetricsIntervalMs)) {
+        MetricsSnapshot now;
+        metrics::read(now);
+        // Paused: keep the last stretch that had ticks in it
+        if (now[Counter::Ticks] > metricsMark[Counter::Ticks]) metricsWindow = now.since(metricsMark);
+        metricsMark = now;
+        marked = t;
+    }
+    return &metricsWindow;
+}
 
-        glBegin(GL_QUADS);
-        glVertex2f(0, 0);
-        glVertex2f(game.grid.w, 0);
-        glVertex2f(game.grid.w, game.grid.h);
-        glVertex2f(0, game.grid.h);
-        glEnd();
+static void display() {
+    if (!gptr) return;
 
-        glDisable(GL_BLEND);
+    auto& game = *gptr;
 
-        glColor3f(1.0f, 1.0f, 1.0f);
-        std::string msg = "GAME OVER";
-        glRasterPos2f(game.grid.w / 2 - 3, game.grid.h / 2);
-        for (char c : msg) {
-            glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, c);
-        }
+    // Take the newest tick, keeping the previous one to move agents from
+    if (sim->snapshots.fresh()) {
+        prevSnap = sim->snapshots.front();
+        sim->snapshots.acquire();
     }
+    const RenderSnapshot& snap = sim->snapshots.front();
+    float alpha = 1.0f;
+    double span = snap.time - prevSnap.time;
+    if (prevSnap.tick >= 0 && span > 0)
+        alpha = (float)std::clamp((sim->now() - snap.time) / span, 0.0, 1.0);
+
+    glClearColor(0.85f, 1.0f, 0.85f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    applyCamera();
+
+    // Only what is on screen is submitted
+    ViewRect view = visibleView(game.grid);
+    drawTerrain(view);
+
+    // Agents, bullets, trails, grenades and the agents' labels (while cells
+    // are big enough to read them) in one draw. Font pixels stay whole
+    // screen pixels.
+    batch.clear();
+    labelled.clear();
+    float labels = labelScale(view);
+    batchDynamic(prevSnap, snap, alpha, batch, taken, view, labels > 0 ? &labelled : nullptr);
+    batchLabels(batch, labelled, labels);
+    drawBatch(batch);
+
+    // HUD and game-over banner in screen pixels, in a second draw
+    GLint vp[4];
+    glGetIntegerv(GL_VIEWPORT, vp);
+    HudStats stats{ frameRate(), sim->speed(), sim->unlimited(), metricsOverlay() };
+    hud.clear();
+    batchHud(hud, snap, stats, vp[2], vp[3]);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, vp[2], vp[3], 0, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    drawBatch(hud);
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
 
     glutSwapBuffers();
 }
@@ -218,33 +266,60 @@ static void mouseMove(int x, int y) {
     }
 }
 
+static void showSpeed() {
+    std::string title = "AI Battle - ";
+    if (sim->unlimited()) title += "max speed";
+    else if (sim->speed() == 0) title += "paused";
+    else title += std::to_string(sim->speed()).substr(0, 5) + "x";
+    glutSetWindowTitle(title.c_str());
+}
+
+// Space pauses, f toggles fast-forward, + and - double or halve the speed,
+// 0 toggles stepping as fast as possible, m the metrics overlay
+static void keyboard(unsigned char key, int, int) {
+    static double resumeSpeed = 1.0;
+    switch (key) {
+    case ' ':
+        if (sim->speed() > 0) { resumeSpeed = sim->speed(); sim->setSpeed(0); }
+        else sim->setSpeed(resumeSpeed);
+        break;
+    case 'f': case 'F': sim->setSpeed(sim->speed() >= kMaxSpeedup ? 1.0 : kMaxSpeedup); break;
+    case '+': case '=': sim->setSpeed(std::max(sim->speed(), 1.0 / 8) * 2); break;
+    case '-': case '_': sim->setSpeed(std::max(sim->speed() / 2, 1.0 / 8)); break;
+    case '0': sim->setUnlimited(!sim->unlimited()); break;
+    case 'm': case 'M': showMetrics = !showMetrics; return;
+    default: return;
+    }
+    showSpeed();
+}
+
 static int gameOverFrames = 0;
 
+// Frames are paced on their own; the simulation runs at whatever speed it
+// was given on its thread
 static void timer(int) {
-    if (!gptr->running) {
+    if (sim->finished()) {
         gameOverFrames++;
 
         if (gameOverFrames == 1) {
             std::cout << "Game over - stopping timer\n";
         }
 
-        if (gameOverFrames > 90) {
+        if (gameOverFrames > 180) {
             std::cout << "Exiting...\n";
-            exit(0);
+            glutLeaveMainLoop();
+            return;
         }
-
-        glutPostRedisplay();
-        glutTimerFunc(33, timer, 0);
-        return;
     }
 
-    gptr->step();
     glutPostRedisplay();
-    glutTimerFunc(33, timer, 0);
+    glutTimerFunc(16, timer, 0);
 }
 
-void runGraphics(Game& game) {
+void runGraphics(Game& game, double ticksPerSecond) {
     gptr = &game;
+    SimThread thread(game, ticksPerSecond);
+    sim = &thread;
 
     int argc = 1;
     char* argv[1] = { (char*)"app" };
@@ -252,8 +327,14 @@ void runGraphics(Game& game) {
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA);
     glutInitWindowSize(1280, 720);
     glutCreateWindow("AI Battle - Camera System");
+    // Closing the window returns here, so the simulation thread is stopped
+    // before anything it uses is torn down
+    glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
 
     glewInit();
+    glGenBuffers(1, &streamVbo);
+    uploadFont();
+    uploadTerrain(game.grid);
 
     // ✅ Set up 2D projection
     glMatrixMode(GL_PROJECTION);
@@ -265,7 +346,13 @@ void runGraphics(Game& game) {
     glutMouseFunc(mouseDown);
     glutMotionFunc(mouseMove);
     glutMouseWheelFunc(mouseWheel);
+    glutKeyboardFunc(keyboard);
 
-    glutTimerFunc(33, timer, 0);
+    thread.start();
+    showSpeed();
+    glutTimerFunc(16, timer, 0);
     glutMainLoop();
-}
\ No newline at end of file
+
+    thread.stop();
+    sim = nullptr;
+}
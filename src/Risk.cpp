@@ -1,35 +1,93 @@
 // Risk.cpp - Risk map generation for tactical decision making
-// Higher risk near enemies, reduced behind cover (trees/rocks)
+// Higher risk near enemies, but only where an enemy can actually see:
+// each enemy's influence is stamped over its shadowcast field of view.
+// Cover (a static per-cell multiplier built at load) lowers it further.
+// Only chunks within reach of an enemy are allocated.
 
 #include "Risk.h"
+#include "Visibility.h"
+#include "Metrics.h"
 #include <cmath> 
 #include <algorithm>
 
-std::vector<float> makeRisk(const Grid& g, const std::vector<IVec2>& enemyHints, float base)
+namespace
 {
-    std::vector<float> r(g.w * g.h, base);
-    
-    // Add risk radiating from enemy positions
-    for (auto e : enemyHints) {
-        for (int y = 0; y < g.h; ++y) {
-            for (int x = 0; x < g.w; ++x) {
-                float d = std::hypot(float(e.x - x), float(e.y - y));
-                
-                // Risk falls off with distance
-                float add = d < 1.0f ? 1.0f : std::max(0.0f, 1.5f - d * 0.15f);
-                r[y * g.w + x] += add;
+    // Influence 1.5 - 0.15 * d reaches zero at this distance
+    constexpr int kRiskRadius = 10;
+
+    float computeCover(const Grid& g, IVec2 p)
+    {
+        // Standing in trees (or rock) cuts risk by 30%
+        float f = g.blocksLOS(p) ? 0.7f : 1.0f;
+
+        // Every LOS-blocking neighbour shields some directions
+        int shields = 0;
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx) {
+                IVec2 q{ p.x + dx, p.y + dy };
+                if ((dx || dy) && g.inBounds(q) && g.blocksLOS(q)) shields++;
             }
-        }
+        return f * (1.0f - 0.04f * shields);
     }
+}
+
+float coverAt(const Grid& g, IVec2 p)
+{
+    return g.cover.empty() ? computeCover(g, p) : g.cover[p.y * g.w + p.x];
+}
+
+std::vector<float> buildCoverMap(const Grid& g)
+{
+    std::vector<float> cover(g.w * g.h);
+    for (int y = 0; y < g.h; ++y)
+        for (int x = 0; x < g.w; ++x)
+            cover[y * g.w + x] = computeCover(g, { x, y });
+    return cover;
+}
+
+RiskMap makeRisk(const Grid& g, const std::vector<IVec2>& enemyHints, float base)
+{
+    RiskMap r;
+    makeRisk(g, enemyHints, base, r);
+    return r;
+}
+
+void makeRisk(const Grid& g, const std::vector<IVec2>& enemyHints, float base, RiskMap& r)
+{
+    // Far from every enemy the risk is flat: nothing is stored there
+    r.reset(g.w, g.h, base);
+    std::uint64_t written = 0;
     
-    // Reduce risk behind cover
-    for (int y = 0; y < g.h; ++y) {
-        for (int x = 0; x < g.w; ++x) {
-            auto t = g.cells[y * g.w + x];
-            if (t == Tile::Tree || t == Tile::Rock)
-                r[y * g.w + x] *= 0.7f;  // 30% risk reduction for cover
-        }
+    // Add risk radiating from enemy positions, only onto cells they can see
+    for (auto e : enemyHints) {
+        if (!g.inBounds(e)) continue;
+
+        // Wake every chunk the enemy's view can reach, at base risk under cover
+        int cx0 = std::max(0, e.x - kRiskRadius) >> kChunkShift, cx1 = std::min(g.w - 1, e.x + kRiskRadius) >> kChunkShift;
+        int cy0 = std::max(0, e.y - kRiskRadius) >> kChunkShift, cy1 = std::min(g.h - 1, e.y + kRiskRadius) >> kChunkShift;
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                int c = cy * r.chunksAcross() + cx;
+                bool created;
+                float* cells = r.ensure(c, &created);
+                if (!created) continue;
+                IVec2 lo, hi;
+                r.chunkRect(c, lo, hi);
+                written += std::uint64_t(hi.x - lo.x + 1) * (hi.y - lo.y + 1);
+                for (int y = lo.y; y <= hi.y; ++y)
+                    for (int x = lo.x; x <= hi.x; ++x)
+                        cells[RiskMap::local(x, y)] = base * coverAt(g, { x, y });
+            }
+
+        shadowcast(g, e, kRiskRadius, [&](IVec2 p) {
+            float d = std::hypot(float(e.x - p.x), float(e.y - p.y));
+            
+            // Risk falls off with distance
+            float add = d < 1.0f ? 1.0f : std::max(0.0f, 1.5f - d * 0.15f);
+            r.chunk(r.chunkOf(p.x, p.y))[RiskMap::local(p.x, p.y)] += add * coverAt(g, p);
+            written++;
+        });
     }
     
-    return r;
+    metrics::add(Counter::RiskCells, written);
 }
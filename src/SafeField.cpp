@@ -0,0 +1,34 @@
+// SafeField.cpp - Per-tick nearest-safe-cell answers for retreating units
+// One bounded flood per distinct unit cell, looked up by cell afterwards.
+
+#include "SafeField.h"
+#include "BFS.h"
+#include <algorithm>
+
+namespace
+{
+    bool before(IVec2 a, IVec2 b) { return a.y != b.y ? a.y < b.y : a.x < b.x; }
+}
+
+void SafeField::reserve(int units)
+{
+    answers.reserve(units);
+}
+
+void SafeField::update(const Grid& g, const RiskMap& risk, float maxRisk, const IVec2* units, std::size_t count, int radius)
+{
+    answers.clear();
+    for (std::size_t u = 0; u < count; ++u) answers.push_back({ units[u], std::nullopt });
+    std::sort(answers.begin(), answers.end(), [](const Answer& a, const Answer& b) { return before(a.unit, b.unit); });
+    answers.erase(std::unique(answers.begin(), answers.end(), [](const Answer& a, const Answer& b) { return a.unit == b.unit; }),
+                  answers.end());
+    for (Answer& a : answers) a.safe = bfsFindSafe(g, a.unit, risk, maxRisk, radius);
+}
+
+std::optional<IVec2> SafeField::nearest(IVec2 unit) const
+{
+    auto it = std::lower_bound(answers.begin(), answers.end(), unit,
+                               [](const Answer& a, IVec2 p) { return before(a.unit, p); });
+    if (it == answers.end() || it->unit != unit) return std::nullopt;
+    return it->safe;
+}
@@ -0,0 +1,247 @@
+// Scenario.cpp - Scenario files: map, units, starting stats and tunables
+// Parsed once at startup and validated against the loaded map.
+
+#include "Scenario.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_set>
+#include <cctype>
+
+namespace
+{
+    const char* kRoleNames[] = { "commander", "warrior", "medic", "porter" };
+
+    bool parseRole(const std::string& s, Role& r)
+    {
+        for (int i = 0; i < 4; ++i)
+            if (s == kRoleNames[i]) { r = (Role)i; return true; }
+        return false;
+    }
+
+    bool parseTeam(const std::string& s, Team& t)
+    {
+        if (s == "blue") t = Team::Blue;
+        else if (s == "orange") t = Team::Orange;
+        else return false;
+        return true;
+    }
+
+    const char* teamKey(Team t) { return t == Team::Blue ? "blue" : "orange"; }
+
+    // Stat overrides given on one line; -1 where the line says nothing
+    struct StatOverrides {
+        int hp{ -1 }, ammo{ -1 }, grenades{ -1 };
+
+        void applyTo(UnitStats& u) const
+        {
+            if (hp >= 0) u.hp = hp;
+            if (ammo >= 0) u.ammo = ammo;
+            if (grenades >= 0) u.grenades = grenades;
+        }
+    };
+
+    // The rest of the line as hp=N ammo=N grenades=N, in any order
+    bool parseStats(std::istringstream& ss, StatOverrides& o, std::string& error)
+    {
+        std::string kv;
+        while (ss >> kv) {
+            auto eq = kv.find('=');
+            std::string k = kv.substr(0, eq);
+            int* field = k == "hp" ? &o.hp : k == "ammo" ? &o.ammo : k == "grenades" ? &o.grenades : nullptr;
+            if (!field || eq == std::string::npos) {
+                error = "expected hp=N, ammo=N or grenades=N, got '" + kv + "'";
+                return false;
+            }
+            std::istringstream v(kv.substr(eq + 1));
+            if (!(v >> *field) || !v.eof() || *field < 0 || (field == &o.hp && *field == 0)) {
+                error = "bad value in '" + kv + "'";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void writeStats(std::ostream& out, const UnitStats& s, const UnitStats& base)
+    {
+        if (s.hp != base.hp) out << " hp=" << s.hp;
+        if (s.ammo != base.ammo) out << " ammo=" << s.ammo;
+        if (s.grenades != base.grenades) out << " grenades=" << s.grenades;
+    }
+}
+
+UnitStats defaultStats(Role r)
+{
+    if (r == Role::Warrior) return { 100, 20, 2 };
+    return {};
+}
+
+IVec2 Scenario::spawn(Team t, Role r) const
+{
+    for (auto& u : units)
+        if (u.team == t && u.role == r) return u.pos;
+    return { 0, 0 };
+}
+
+bool loadScenario(const std::string& path, Scenario& out, std::string& error)
+{
+    std::ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+    out = Scenario();
+    // stats lines may follow the units they apply to, so unit stats are
+    // resolved once the whole file is read
+    StatOverrides roleStats[2][4];
+    std::vector<StatOverrides> unitStats;
+    Tunables scratch;
+    std::string line;
+    for (int n = 1; std::getline(in, line); ++n) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ss(line);
+        std::string key;
+        if (!(ss >> key)) continue;
+
+        auto fail = [&](const std::string& msg) {
+            error = path + ":" + std::to_string(n) + ": " + msg;
+            return false;
+        };
+        std::string msg;
+        if (key == "name") {
+            std::getline(ss >> std::ws, out.name);
+            while (!out.name.empty() && std::isspace((unsigned char)out.name.back())) out.name.pop_back();
+        }
+        else if (key == "map") {
+            if (!(ss >> out.map)) return fail("map needs a path");
+            // Relative to the scenario file, like an #include
+            auto slash = path.find_last_of("/\\");
+            if (slash != std::string::npos && out.map[0] != '/' && out.map.find(':') == std::string::npos)
+                out.map = path.substr(0, slash + 1) + out.map;
+        }
+        else if (key == "unit") {
+            std::string team, role;
+            ScenarioUnit u{};
+            StatOverrides o;
+            if (!(ss >> team >> role >> u.pos.x >> u.pos.y)) return fail("expected: unit <team> <role> <x> <y>");
+            if (!parseTeam(team, u.team)) return fail("unknown team '" + team + "'");
+            if (!parseRole(role, u.role)) return fail("unknown role '" + role + "'");
+            if (!parseStats(ss, o, msg)) return fail(msg);
+            out.units.push_back(u);
+            unitStats.push_back(o);
+        }
+        else if (key == "stats") {
+            std::string team, role;
+            Team t;
+            Role r;
+            if (!(ss >> team >> role)) return fail("expected: stats <team> <role> [hp=N] [ammo=N] [grenades=N]");
+            if (!parseTeam(team, t)) return fail("unknown team '" + team + "'");
+            if (!parseRole(role, r)) return fail("unknown role '" + role + "'");
+            if (!parseStats(ss, roleStats[(int)t][(int)r], msg)) return fail(msg);
+        }
+        else if (key == "tune") {
+            std::string name, value, extra;
+            if (!(ss >> name >> value) || (ss >> extra)) return fail("expected: tune <name> <value>");
+            if (!setTunable(scratch, name, value, msg)) return fail(msg);
+            out.tunes.emplace_back(name, value);
+        }
+        else return fail("unknown declaration '" + key + "'");
+    }
+    if (out.map.empty()) {
+        error = path + ": no map declared";
+        return false;
+    }
+    for (std::size_t i = 0; i < out.units.size(); ++i) {
+        auto& u = out.units[i];
+        u.stats = defaultStats(u.role);
+        roleStats[(int)u.team][(int)u.role].applyTo(u.stats);
+        unitStats[i].applyTo(u.stats);
+    }
+    return true;
+}
+
+bool saveScenario(const Scenario& s, const std::string& path)
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    out << "# ai_battle scenario\n";
+    if (!s.name.empty()) out << "name " << s.name << "\n";
+    out << "map " << s.map << "\n";
+    for (auto& t : s.tunes)
+        out << "tune " << t.first << ' ' << t.second << "\n";
+    for (auto& u : s.units) {
+        out << "unit " << teamKey(u.team) << ' ' << kRoleNames[(int)u.role] << ' ' << u.pos.x << ' ' << u.pos.y;
+        writeStats(out, u.stats, defaultStats(u.role));
+        out << "\n";
+    }
+    return (bool)out;
+}
+
+bool applyScenarioTunables(const Scenario& s, std::string& error)
+{
+    for (auto& t : s.tunes)
+        if (!applyTunables(t.first, t.second, error)) return false;
+    return true;
+}
+
+bool validateScenario(const Scenario& s, const Grid& g, std::string& error)
+{
+    std::unordered_set<std::size_t> taken;
+    int counts[2][4] = {};
+    for (auto& u : s.units) {
+        std::ostringstream where;
+        where << teamKey(u.team) << ' ' << kRoleNames[(int)u.role] << " at (" << u.pos.x << "," << u.pos.y << ")";
+        if (!g.inBounds(u.pos)) { error = where.str() + " is off the map"; return false; }
+        if (!g.passable(u.pos)) { error = where.str() + " is not on a passable cell"; return false; }
+        if (!taken.insert((std::size_t)u.pos.y * g.w + u.pos.x).second) {
+            error = where.str() + " shares its cell";
+            return false;
+        }
+        counts[(int)u.team][(int)u.role]++;
+    }
+    for (Team t : { Team::Blue, Team::Orange })
+        for (Role r : { Role::Commander, Role::Medic, Role::Porter, Role::Warrior }) {
+            int c = counts[(int)t][(int)r];
+            bool ok = r == Role::Warrior ? c >= 1 : c == 1;
+            if (!ok) {
+                error = std::string(teamKey(t)) + " needs " + (r == Role::Warrior ? "at least one " : "exactly one ")
+                      + kRoleNames[(int)r] + ", has " + std::to_string(c);
+                return false;
+            }
+        }
+    return true;
+}
+
+Scenario cornerScenario(const Grid& g, int baseSize, int warriorsPerTeam)
+{
+    Scenario s;
+    // Sets, not W*H arrays: only the cells around the bases are touched
+    std::unordered_set<std::size_t> taken;
+    for (IVec2 d : { g.blueAmmo, g.blueMed, g.orangeAmmo, g.orangeMed })
+        if (g.inBounds(d)) taken.insert((std::size_t)d.y * g.w + d.x);
+
+    for (Team t : { Team::Blue, Team::Orange }) {
+        // Breadth-first from the base's centre, so units fill the base first
+        IVec2 home = t == Team::Blue ? IVec2{ baseSize / 2, baseSize / 2 }
+                                     : IVec2{ g.w - 1 - baseSize / 2, g.h - 1 - baseSize / 2 };
+        std::vector<IVec2> cells{ home };
+        std::unordered_set<std::size_t> seen{ (std::size_t)home.y * g.w + home.x };
+        std::vector<Role> roles{ Role::Commander, Role::Medic, Role::Porter };
+        roles.insert(roles.end(), warriorsPerTeam, Role::Warrior);
+
+        std::size_t next = 0;
+        for (std::size_t head = 0; head < cells.size() && next < roles.size(); ++head) {
+            IVec2 p = cells[head];
+            std::size_t i = (std::size_t)p.y * g.w + p.x;
+            if (g.passable(p) && taken.insert(i).second) {
+                s.units.push_back({ t, roles[next], p, defaultStats(roles[next]) });
+                ++next;
+            }
+            for (IVec2 q : { IVec2{ p.x + 1, p.y }, IVec2{ p.x - 1, p.y }, IVec2{ p.x, p.y + 1 }, IVec2{ p.x, p.y - 1 } }) {
+                if (!g.inBounds(q) || !g.passable(q)) continue;
+                if (seen.insert((std::size_t)q.y * g.w + q.x).second) cells.push_back(q);
+            }
+        }
+    }
+    return s;
+}
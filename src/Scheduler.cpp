@@ -0,0 +1,31 @@
+// Scheduler.cpp - Event and wake-up timer scheduling for team AI
+// Lets the commander skip scans that cannot produce a new decision
+
+#include "Scheduler.h"
+
+int AgentScheduler::subscribe(std::uint32_t eventMask)
+{
+    watchers.push_back({ eventMask, true });
+    return (int)watchers.size() - 1;
+}
+
+void AgentScheduler::post(AgentEvent e)
+{
+    std::uint32_t bit = eventBit(e);
+    for (auto& w : watchers)
+        if (w.mask & bit)
+            w.awake = true;
+}
+
+void AgentScheduler::wakeAt(int tick, AgentEvent e)
+{
+    timers.push({ tick, e });
+}
+
+void AgentScheduler::advance(int tick)
+{
+    while (!timers.empty() && timers.top().tick <= tick) {
+        post(timers.top().ev);
+        timers.pop();
+    }
+}
@@ -0,0 +1,83 @@
+// SimThread.cpp - Simulation loop decoupled from the renderer
+// Paces Game::step against a deadline clock and hands snapshots over
+// through a triple buffer, so a slow tick never stalls a frame.
+
+#include "SimThread.h"
+#include "Game.h"
+#include <algorithm>
+
+SimThread::SimThread(Game& g, double ticksPerSecond)
+    : game(g)
+    , baseRate(ticksPerSecond > 0 ? ticksPerSecond : kTickRate)
+    , unlimitedFlag(ticksPerSecond <= 0)
+    , epoch(std::chrono::steady_clock::now())
+{
+}
+
+SimThread::~SimThread()
+{
+    stop();
+}
+
+void SimThread::start()
+{
+    if (thread.joinable()) return;
+    stopping = false;
+    epoch = std::chrono::steady_clock::now();
+    publish(0);  // the renderer has the initial state before the first tick
+    thread = std::thread([this] { run(); });
+}
+
+void SimThread::stop()
+{
+    stopping = true;
+    if (thread.joinable()) thread.join();
+}
+
+void SimThread::setSpeed(double factor)
+{
+    speedFactor = std::clamp(factor, 0.0, (double)kMaxSpeedup);
+}
+
+double SimThread::now() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void SimThread::publish(float tickMs)
+{
+    captureSnapshot(game, now(), snapshots.back());
+    snapshots.back().tickMs = tickMs;
+    snapshots.publish();
+}
+
+void SimThread::run()
+{
+    using clock = std::chrono::steady_clock;
+    auto next = clock::now();
+    while (!stopping && game.running) {
+        auto t = clock::now();
+        double factor = speedFactor;
+        if (!unlimitedFlag) {
+            if (factor <= 0) {
+                // Paused: poll for a new speed, then restart pacing from now
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                next = clock::now();
+                continue;
+            }
+            if (t < next) {
+                // Short naps so speed changes take effect promptly
+                std::this_thread::sleep_until(std::min(next, t + std::chrono::milliseconds(10)));
+                continue;
+            }
+            next += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / (baseRate * factor)));
+            // Fell far behind (a slow tick, a debugger): skip ahead rather
+            // than replaying the backlog at full speed
+            if (t - next > std::chrono::milliseconds(250)) next = t;
+        }
+        auto t0 = clock::now();
+        game.step();
+        publish(std::chrono::duration<float, std::milli>(clock::now() - t0).count());
+    }
+    done = !game.running;
+}
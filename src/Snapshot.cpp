@@ -0,0 +1,32 @@
+// Snapshot.cpp - Render snapshots taken by the simulation thread
+// Copies positions and display state only; the renderer never sees Game.
+
+#include "Snapshot.h"
+#include "Game.h"
+
+void captureSnapshot(const Game& game, double time, RenderSnapshot& out)
+{
+    out.tick = game.tick;
+    out.running = game.running;
+    out.time = time;
+
+    out.agents.clear();
+    auto agent = [&](const Agent& a, Role r) {
+        out.agents.push_back({ (float)a.pos.x, (float)a.pos.y, a.hp, a.glyph, a.team, r, a.alive, a.incapacitated });
+    };
+    for (auto* t : { &game.blue, &game.orange }) {
+        agent(t->commander, Role::Commander);
+        for (auto& w : t->warriors) agent(w, Role::Warrior);
+        agent(t->medic, Role::Medic);
+        agent(t->porter, Role::Porter);
+    }
+
+    out.bullets.clear();
+    out.trails.clear();
+    for (const auto& b : game.bullets.bullets) {
+        if (b.alive) out.bullets.push_back({ b.x, b.y });
+        for (int i = 0; i < b.trailLength; ++i) out.trails.push_back({ b.trail[i].x, b.trail[i].y });
+    }
+    out.grenades.clear();
+    for (const auto& g : game.grenades.grenades) out.grenades.push_back({ g.x, g.y });
+}
@@ -0,0 +1,127 @@
+// SoftRenderer.cpp - Software rasteriser for headless video
+// Follows the GL path's conventions: the map spans the whole frame at zoom 1,
+// a pixel belongs to a quad when its centre is inside, and texels are
+// sampled nearest.
+
+#include "SoftRenderer.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const Rgba8 kClear = rgb(0.85f, 1.0f, 0.85f);
+
+    inline void blend(std::uint8_t* p, Rgba8 c, int a)
+    {
+        p[0] = (std::uint8_t)((c.r * a + p[0] * (255 - a) + 127) / 255);
+        p[1] = (std::uint8_t)((c.g * a + p[1] * (255 - a) + 127) / 255);
+        p[2] = (std::uint8_t)((c.b * a + p[2] * (255 - a) + 127) / 255);
+    }
+
+    // Pixels whose centres lie in [a, b), clipped to [0, n)
+    inline void span(float a, float b, int n, int& lo, int& hi)
+    {
+        lo = std::max(0, (int)std::ceil(a - 0.5f));
+        hi = std::min(n, (int)std::ceil(b - 0.5f));
+    }
+}
+
+SoftRenderer::SoftRenderer(const Grid& g, int width, int height, const Camera& c)
+    : cam(c)
+    , sx(c.zoom * width / g.w)
+    , sy(c.zoom * height / g.h)
+{
+    cam.visibleRect((float)g.w, (float)g.h, view.x0, view.y0, view.x1, view.y1);
+    view.pixel = std::max((view.x1 - view.x0) / width, (view.y1 - view.y0) / height);
+
+    // Cell under each pixel centre; rows over the same cell row are copies
+    background.resize(width, height);
+    std::vector<int> cols(width);
+    for (int x = 0; x < width; ++x) {
+        int cx = (int)std::floor(cam.x + (x + 0.5f) / sx);
+        cols[x] = cx >= 0 && cx < g.w ? cx : -1;
+    }
+    int lastRow = -2;
+    for (int y = 0; y < height; ++y) {
+        int cy = (int)std::floor(cam.y + (y + 0.5f) / sy);
+        if (cy < 0 || cy >= g.h) cy = -1;
+        std::uint8_t* dst = &background.rgb[(std::size_t)y * width * 3];
+        if (cy == lastRow) {
+            std::memcpy(dst, dst - (std::size_t)width * 3, (std::size_t)width * 3);
+            continue;
+        }
+        lastRow = cy;
+        for (int x = 0; x < width; ++x, dst += 3) {
+            Rgba8 c = cy >= 0 && cols[x] >= 0 ? tileColor(g.cells[(std::size_t)cy * g.w + cols[x]]) : kClear;
+            dst[0] = c.r;
+            dst[1] = c.g;
+            dst[2] = c.b;
+        }
+    }
+}
+
+void SoftRenderer::drawQuads(const QuadBatch& batch, float ox, float oy, float qsx, float qsy, Framebuffer& fb,
+                             std::vector<PixelRect>& dirty) const
+{
+    for (std::size_t i = 0; i + 3 < batch.verts.size(); i += 4) {
+        const QuadBatch::Vertex& a = batch.verts[i];
+        const QuadBatch::Vertex& b = batch.verts[i + 2];
+        float x0 = (a.x - ox) * qsx, x1 = (b.x - ox) * qsx;
+        float y0 = (a.y - oy) * qsy, y1 = (b.y - oy) * qsy;
+        int px0, px1, py0, py1;
+        span(x0, x1, fb.w, px0, px1);
+        span(y0, y1, fb.h, py0, py1);
+        if (px0 >= px1 || py0 >= py1) continue;
+        dirty.push_back({ px0, py0, px1, py1 });
+
+        const Rgba8 c = a.c;
+        if (a.u == b.u && a.v == b.v) {
+            // The atlas's solid cell: a flat colour
+            for (int y = py0; y < py1; ++y) {
+                std::uint8_t* p = &fb.rgb[((std::size_t)y * fb.w + px0) * 3];
+                if (c.a == 255) {
+                    for (int x = px0; x < px1; ++x, p += 3) { p[0] = c.r; p[1] = c.g; p[2] = c.b; }
+                }
+                else {
+                    for (int x = px0; x < px1; ++x, p += 3) blend(p, c, c.a);
+                }
+            }
+            continue;
+        }
+
+        // A glyph: nearest texel of the atlas, ink blended in the vertex colour
+        const float du = (b.u - a.u) / (x1 - x0), dv = (b.v - a.v) / (y1 - y0);
+        for (int y = py0; y < py1; ++y) {
+            int ty = std::min(FontAtlas::kHeight - 1, (int)((a.v + (y + 0.5f - y0) * dv) * FontAtlas::kHeight));
+            const std::uint8_t* row = &atlas.alpha[(std::size_t)ty * FontAtlas::kWidth];
+            std::uint8_t* p = &fb.rgb[((std::size_t)y * fb.w + px0) * 3];
+            for (int x = px0; x < px1; ++x, p += 3) {
+                int tx = std::min(FontAtlas::kWidth - 1, (int)((a.u + (x + 0.5f - x0) * du) * FontAtlas::kWidth));
+                int ink = row[tx] * c.a / 255;
+                if (ink) blend(p, c, ink);
+            }
+        }
+    }
+}
+
+void SoftRenderer::render(const RenderSnapshot& prev, const RenderSnapshot& cur, float alpha, const HudStats& hud,
+                          Framebuffer& fb, Scratch& scratch) const
+{
+    fb.w = background.w;
+    fb.h = background.h;
+    fb.rgb = background.rgb;
+
+    scratch.batch.clear();
+    scratch.labels.clear();
+    scratch.dirty.clear();
+    float labels = labelScale(view);
+    batchDynamic(prev, cur, alpha, scratch.batch, scratch.taken, view, labels > 0 ? &scratch.labels : nullptr);
+    batchLabels(scratch.batch, scratch.labels, labels);
+    drawQuads(scratch.batch, cam.x, cam.y, sx, sy, fb, scratch.dirty);
+
+    scratch.batch.clear();
+    batchHud(scratch.batch, cur, hud, fb.w, fb.h);
+    drawQuads(scratch.batch, 0, 0, 1, 1, fb, scratch.dirty);
+}
@@ -0,0 +1,97 @@
+// TaskPool.cpp - Worker threads for parallel AI and path solving
+
+#include "TaskPool.h"
+#include <atomic>
+#include <algorithm>
+
+TaskPool::TaskPool(unsigned workers)
+{
+    for (unsigned i = 0; i < workers; ++i)
+        threads.emplace_back([this] { workerLoop(); });
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : threads)
+        t.join();
+}
+
+TaskPool& TaskPool::shared()
+{
+    static TaskPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void TaskPool::run(const Task& t)
+{
+    t.fn(t.index);
+    if (t.remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Under m, so a caller between its check and its wait cannot miss it
+        std::lock_guard<std::mutex> lock(m);
+        progress.notify_all();
+    }
+}
+
+TaskPool::Task TaskPool::popLocked()
+{
+    Task t = queue[head++];
+    if (head == queue.size()) {
+        queue.clear();
+        head = 0;
+    }
+    return t;
+}
+
+bool TaskPool::tryRunOne()
+{
+    std::unique_lock<std::mutex> lock(m);
+    if (head == queue.size()) return false;
+    Task t = popLocked();
+    lock.unlock();
+    run(t);
+    return true;
+}
+
+void TaskPool::workerLoop()
+{
+    while (true) {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this] { return stopping || head < queue.size(); });
+        if (stopping && head == queue.size()) return;
+        Task t = popLocked();
+        lock.unlock();
+        run(t);
+    }
+}
+
+void TaskPool::parallelFor(int count, FunctionRef<void(int)> fn)
+{
+    if (count <= 0) return;
+
+    if (threads.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::atomic<int> remaining{ count };
+    {
+        std::lock_guard<std::mutex> lock(m);
+        for (int i = 0; i < count; ++i)
+            queue.push_back({ fn, &remaining, i });
+    }
+    cv.notify_all();
+    progress.notify_all();
+
+    // Help out until our own batch is done, then sleep instead of spinning
+    // against the workers for the rest of it
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (tryRunOne()) continue;
+        std::unique_lock<std::mutex> lock(m);
+        progress.wait(lock, [&] { return remaining.load(std::memory_order_acquire) == 0 || head < queue.size(); });
+    }
+}
@@ -0,0 +1,56 @@
+// TickArena.cpp - Bump allocation over blocks kept from tick to tick
+
+#include "TickArena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+TickArena::~TickArena()
+{
+    for (const Block& b : blocks) ::operator delete(b.data);
+}
+
+std::size_t TickArena::capacity() const
+{
+    std::size_t n = 0;
+    for (const Block& b : blocks) n += b.size;
+    return n;
+}
+
+void TickArena::addBlock(std::size_t size)
+{
+    blocks.push_back({ static_cast<std::byte*>(::operator new(size)), size });
+}
+
+void* TickArena::do_allocate(std::size_t bytes, std::size_t align)
+{
+    for (;;) {
+        if (current < blocks.size()) {
+            const Block& b = blocks[current];
+            auto base = reinterpret_cast<std::uintptr_t>(b.data);
+            std::size_t start = ((base + offset + align - 1) & ~std::uintptr_t(align - 1)) - base;
+            if (start + bytes <= b.size) {
+                usedBytes += start - offset + bytes;
+                offset = start + bytes;
+                return b.data + start;
+            }
+        }
+        // Each new block at least doubles the arena
+        addBlock(std::max(blocks.empty() ? firstBlock : blocks.back().size * 2, bytes + align));
+        current = blocks.size() - 1;
+        offset = 0;
+    }
+}
+
+void TickArena::reset()
+{
+    if (blocks.size() > 1) {
+        std::size_t total = capacity();
+        for (const Block& b : blocks) ::operator delete(b.data);
+        blocks.clear();
+        addBlock(total);
+    }
+    current = 0;
+    offset = 0;
+    usedBytes = 0;
+}
@@ -0,0 +1,72 @@
+// Tunables.cpp - Gameplay numbers overridable at startup
+// Name lookup for scenario "tune" lines and --tune on the command line.
+
+#include "Tunables.h"
+#include <cstdlib>
+#include <cerrno>
+
+#ifndef AI_FIXED_TUNABLES
+Tunables g_tunables;
+#endif
+
+namespace
+{
+    struct Field {
+        const char* name;
+        int Tunables::* member;
+    };
+
+    const Field kFields[] = {
+        { "gunRange", &Tunables::gunRange },
+        { "gunDamage", &Tunables::gunDamage },
+        { "grenadeRange", &Tunables::grenadeRange },
+        { "grenadeDamage", &Tunables::grenadeDamage },
+        { "advanceRange", &Tunables::advanceRange },
+        { "medCallHP", &Tunables::medCallHP },
+        { "reviveHP", &Tunables::reviveHP },
+        { "maxWarriorRevives", &Tunables::maxWarriorRevives },
+        { "lowAmmo", &Tunables::lowAmmo },
+        { "resupplyAmmo", &Tunables::resupplyAmmo },
+        { "resupplyGrenades", &Tunables::resupplyGrenades },
+        { "porterCooldown", &Tunables::porterCooldown },
+        { "forceCommanderFocusTick", &Tunables::forceCommanderFocusTick },
+        { "lodDistance", &Tunables::lodDistance },
+        { "lodInterval", &Tunables::lodInterval },
+        { "lodSkipScans", &Tunables::lodSkipScans },
+    };
+}
+
+bool setTunable(Tunables& t, const std::string& name, const std::string& value, std::string& error)
+{
+    for (auto& f : kFields) {
+        if (name != f.name) continue;
+        char* end = nullptr;
+        errno = 0;
+        long v = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || errno == ERANGE || v < -1000000000L || v > 1000000000L) {
+            error = "tunable " + name + ": '" + value + "' is not a whole number";
+            return false;
+        }
+        t.*f.member = (int)v;
+        return true;
+    }
+    error = "unknown tunable '" + name + "'";
+    return false;
+}
+
+bool applyTunables(const std::string& name, const std::string& value, std::string& error)
+{
+#ifdef AI_FIXED_TUNABLES
+    Tunables t = kFixedTunables;
+    if (!setTunable(t, name, value, error)) return false;
+    for (auto& f : kFields)
+        if (t.*f.member != kFixedTunables.*f.member) {
+            error = "tunable " + name + " is fixed at " + std::to_string(kFixedTunables.*f.member)
+                  + " in this build (AI_FIXED_TUNABLES)";
+            return false;
+        }
+    return true;
+#else
+    return setTunable(g_tunables, name, value, error);
+#endif
+}
@@ -0,0 +1,167 @@
+// VideoExport.cpp - Headless replay video through the software rasteriser
+// The game runs on the calling thread; whenever a batch of snapshots is
+// recorded, the frames are rendered and encoded side by side.
+
+#include "VideoExport.h"
+#include "Game.h"
+#include "TaskPool.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    const char kFrame[] = "FRAME\n";
+}
+
+VideoExport::VideoExport(const Grid& g, int width, int height, int framesPerSecond)
+    : renderer(g, width, height)
+    , fps(framesPerSecond)
+{
+    // Enough frames per batch to keep every thread busy, bounded for memory
+    int threads = (int)TaskPool::shared().workerCount() + 1;
+    slots.resize(std::clamp(threads * 2, 4, kVideoBatch));
+}
+
+VideoExport::~VideoExport()
+{
+    if (file) std::fclose(file);
+}
+
+bool VideoExport::open(const std::string& path, std::string& error)
+{
+    if (renderer.width() < 2 || renderer.height() < 2 || renderer.width() % 2 || renderer.height() % 2) {
+        error = "Video size must be even and at least 2x2";
+        return false;
+    }
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "Cannot write " + path;
+        return false;
+    }
+    y4m = path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+    if (y4m) {
+        std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", renderer.width(), renderer.height(), fps);
+        const Framebuffer& bg = renderer.backgroundImage();
+        background.assign(6 + (std::size_t)bg.w * bg.h * 3 / 2, 0);
+        std::copy(kFrame, kFrame + 6, background.begin());
+        encode(bg, PixelRect{ 0, 0, bg.w, bg.h }, background);
+    }
+    return true;
+}
+
+RenderSnapshot& VideoExport::record()
+{
+    if (pending == (int)slots.size()) flush();
+    return slots[pending++].snap;
+}
+
+void VideoExport::encode(const Framebuffer& fb, const PixelRect& r, std::vector<std::uint8_t>& out) const
+{
+    // BT.601 studio range; chroma from the average of each 2x2 block
+    const std::size_t pixels = (std::size_t)fb.w * fb.h;
+    std::uint8_t* yPlane = &out[6];
+    std::uint8_t* uPlane = yPlane + pixels;
+    std::uint8_t* vPlane = uPlane + pixels / 4;
+    auto luma = [](const std::uint8_t* p) {
+        return (std::uint8_t)(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+    };
+    const int x0 = r.x0 & ~1, x1 = std::min(fb.w, (r.x1 + 1) & ~1);
+    const int y0 = r.y0 & ~1, y1 = std::min(fb.h, (r.y1 + 1) & ~1);
+    for (int y = y0; y < y1; y += 2) {
+        const std::uint8_t* r0 = &fb.rgb[((std::size_t)y * fb.w + x0) * 3];
+        const std::uint8_t* r1 = r0 + (std::size_t)fb.w * 3;
+        std::uint8_t* l0 = yPlane + (std::size_t)y * fb.w;
+        std::uint8_t* l1 = l0 + fb.w;
+        std::uint8_t* u = uPlane + (std::size_t)(y / 2) * (fb.w / 2) + x0 / 2;
+        std::uint8_t* v = vPlane + (std::size_t)(y / 2) * (fb.w / 2) + x0 / 2;
+        for (int x = x0; x < x1; x += 2, r0 += 6, r1 += 6) {
+            l0[x] = luma(r0);
+            l0[x + 1] = luma(r0 + 3);
+            l1[x] = luma(r1);
+            l1[x + 1] = luma(r1 + 3);
+            int red = r0[0] + r0[3] + r1[0] + r1[3];
+            int green = r0[1] + r0[4] + r1[1] + r1[4];
+            int blue = r0[2] + r0[5] + r1[2] + r1[5];
+            *u++ = (std::uint8_t)(((-38 * red - 74 * green + 112 * blue + 512) >> 10) + 128);
+            *v++ = (std::uint8_t)(((112 * red - 94 * green - 18 * blue + 512) >> 10) + 128);
+        }
+    }
+}
+
+void VideoExport::flush()
+{
+    if (pending == 0) return;
+    auto t0 = std::chrono::steady_clock::now();
+    // One frame per tick, so agents sit where their snapshot has them
+    const HudStats hud{ (float)fps, 1.0, false };
+    TaskPool::shared().parallelFor(pending, [&](int i) {
+        Slot& s = slots[i];
+        renderer.render(s.snap, s.snap, 1.0f, hud, s.fb, s.scratch);
+        if (!y4m) return;
+        // Most of a frame is the background: start from its conversion and
+        // redo only what the quads touched
+        s.bytes = background;
+        for (const PixelRect& r : s.scratch.dirty) encode(s.fb, r, s.bytes);
+    });
+    renderTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    for (int i = 0; i < pending; ++i) write(slots[i]);
+    written += pending;
+    // The last frame stays in slot 0 for finish() to repeat
+    if (pending > 1) std::swap(slots[0], slots[pending - 1]);
+    pending = 0;
+}
+
+void VideoExport::write(const Slot& s)
+{
+    if (!file) return;
+    if (!y4m) std::fprintf(file, "P6\n%d %d\n255\n", s.fb.w, s.fb.h);
+    const auto& bytes = y4m ? s.bytes : s.fb.rgb;
+    if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) failed = true;
+}
+
+bool VideoExport::finish(int holdFrames)
+{
+    flush();
+    if (!file) return false;
+    if (written > 0) {
+        for (int i = 0; i < holdFrames; ++i) write(slots[0]);
+        written += holdFrames;
+    }
+    if (std::fclose(file) != 0) failed = true;
+    file = nullptr;
+    return !failed;
+}
+
+int runVideo(Game& game, const std::string& path, int width, int height)
+{
+    VideoExport video(game.grid, width, height, (int)kTickRate);
+    std::string error;
+    if (!video.open(path, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    int frames = 1;
+    captureSnapshot(game, 0, video.record());
+    while (game.running) {
+        auto s0 = std::chrono::steady_clock::now();
+        game.step();
+        float tickMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - s0).count();
+        RenderSnapshot& snap = video.record();
+        captureSnapshot(game, game.tick / kTickRate, snap);
+        snap.tickMs = tickMs;
+        frames++;
+    }
+    if (!video.finish(kVideoHoldSeconds * (int)kTickRate)) {
+        std::cerr << "Writing " << path << " failed" << std::endl;
+        return 1;
+    }
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    double render = video.renderSeconds();
+    std::cout << "Wrote " << video.framesWritten() << " frames (" << width << "x" << height << ") to " << path
+              << " in " << total << " s; drawing and encoding " << frames << " frames took " << render << " s ("
+              << (render > 0 ? frames / render : 0) << " fps)" << std::endl;
+    return 0;
+}
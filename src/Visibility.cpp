@@ -1,8 +1,12 @@
 // Visibility.cpp - Line of sight calculations using Bresenham's algorithm
+// and field of view by recursive shadowcasting
 // Trees and rocks block LOS, water does not
 
 #include "Visibility.h"
+#include "Metrics.h"
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 // Check if there's line of sight between two positions
 bool los(const Grid& g, IVec2 a, IVec2 b)
@@ -12,11 +16,16 @@ bool los(const Grid& g, IVec2 a, IVec2 b)
     int dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
     int err = dx + dy, e2;
     IVec2 p = a;
+    int walked = 0;
+    bool clear = true;
     
     while (true) {
+        walked++;
         // Don't check start and end positions
-        if (!(p == a) && !(p == b) && g.blocksLOS(p))
-            return false;
+        if (!(p == a) && !(p == b) && g.blocksLOS(p)) {
+            clear = false;
+            break;
+        }
         
         if (p.x == x1 && p.y == y1)
             break;
@@ -25,11 +34,15 @@ bool los(const Grid& g, IVec2 a, IVec2 b)
         if (e2 >= dy) { err += dy; p.x += sx; }
         if (e2 <= dx) { err += dx; p.y += sy; }
         
-        if (!g.inBounds(p))
-            return false;
+        if (!g.inBounds(p)) {
+            clear = false;
+            break;
+        }
     }
     
-    return true;
+    metrics::add(Counter::LosChecks);
+    metrics::add(Counter::LosCells, walked);
+    return clear;
 }
 
 // Alternative ray-line implementation
@@ -57,3 +70,71 @@ bool rayLine(const Grid& g, IVec2 a, IVec2 b)
     
     return true;
 }
+
+namespace
+{
+    // One octant of recursive shadowcasting. Rows move away from the origin;
+    // [start, end] is the still-lit slope range, narrowed by blockers.
+    void castLight(const Grid& g, IVec2 o, int row, float start, float end, int radius,
+                   int xx, int xy, int yx, int yy, FunctionRef<void(IVec2)> visit)
+    {
+        if (start < end) return;
+        float newStart = 0.f;
+        for (int j = row; j <= radius; ++j) {
+            bool blocked = false;
+            for (int dx = -j, dy = -j; dx <= 0; ++dx) {
+                IVec2 p{ o.x + dx * xx + dy * xy, o.y + dx * yx + dy * yy };
+                float lSlope = (dx - 0.5f) / (dy + 0.5f);
+                float rSlope = (dx + 0.5f) / (dy - 0.5f);
+                if (start < rSlope) continue;
+                if (end > lSlope) break;
+
+                bool inside = g.inBounds(p);
+                if (inside && dx * dx + dy * dy <= radius * radius) visit(p);
+
+                bool opaque = !inside || g.blocksLOS(p);
+                if (blocked) {
+                    if (opaque) { newStart = rSlope; continue; }
+                    blocked = false;
+                    start = newStart;
+                } else if (opaque && j < radius) {
+                    blocked = true;
+                    castLight(g, o, j + 1, start, lSlope, radius, xx, xy, yx, yy, visit);
+                    newStart = rSlope;
+                }
+            }
+            if (blocked) break;
+        }
+    }
+}
+
+void shadowcast(const Grid& g, IVec2 origin, int radius, FunctionRef<void(IVec2)> visit)
+{
+    // Octant borders are shared, so cells there come up twice: stamp them
+    // in a box around the origin
+    const int side = 2 * radius + 1;
+    thread_local std::vector<unsigned> stamp;
+    thread_local unsigned generation = 0;
+    if (stamp.size() < (size_t)side * side || ++generation == 0) {
+        stamp.assign(std::max(stamp.size(), (size_t)side * side), 0);
+        generation = 1;
+    }
+    auto once = [&](IVec2 p) {
+        unsigned& s = stamp[(p.y - origin.y + radius) * side + (p.x - origin.x + radius)];
+        if (s == generation) return;
+        s = generation;
+        visit(p);
+    };
+    FunctionRef<void(IVec2)> visitOnce = once;
+
+    visitOnce(origin);
+    static const int mult[4][8] = {
+        { 1, 0, 0, -1, -1, 0, 0, 1 },
+        { 0, 1, -1, 0, 0, -1, 1, 0 },
+        { 0, 1, 1, 0, 0, -1, -1, 0 },
+        { 1, 0, 0, 1, -1, 0, 0, -1 },
+    };
+    for (int oct = 0; oct < 8; ++oct)
+        castLight(g, origin, 1, 1.0f, 0.0f, radius,
+                  mult[0][oct], mult[1][oct], mult[2][oct], mult[3][oct], visitOnce);
+}
@@ -1,69 +1,233 @@
 #include "Game.h" 
 #include "Renderer.h" 
 #include "Logger.h"
+#include "Bench.h"
+#include "MapFile.h"
+#include "MapGen.h"
+#include "Scenario.h"
+#include "VideoExport.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "Events.h"
 #include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 // Global logger instance
 Logger* g_logger = nullptr;
 
 int main(int argc, char* argv[]){
-    // Initialize logger
-    g_logger = new Logger("game_log.txt");
-    // Configuration selection
-    GameConfig config;
-    
-    if (argc > 1) {
-        // Command line argument: 1=balanced, 2=blue advantage, 3=orange advantage
-        int choice = std::atoi(argv[1]);
-        if (choice == 2) {
-            config = GameConfig::BlueAdvantage();
-            std::cout << "=== BLUE ADVANTAGE CONFIGURATION ===" << std::endl;
-        } else if (choice == 3) {
-            config = GameConfig::OrangeAdvantage();
-            std::cout << "=== ORANGE ADVANTAGE CONFIGURATION ===" << std::endl;
-        } else {
-            config = GameConfig::Balanced();
-            std::cout << "=== BALANCED CONFIGURATION ===" << std::endl;
-        }
-    } else {
-        // Interactive menu
-        std::cout << "\n========== AI BATTLE GAME ==========" << std::endl;
-        std::cout << "Select configuration:" << std::endl;
-        std::cout << "1. Balanced (Equal strength)" << std::endl;
-        std::cout << "2. Blue Advantage (+50 HP, +10 Ammo, +2 Grenades)" << std::endl;
-        std::cout << "3. Orange Advantage (+50 HP, +10 Ammo, +2 Grenades)" << std::endl;
-        std::cout << "Enter choice (1-3): ";
-        
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+        return runBench(argc, argv);
+    // Convert a text map to a binary .aimap with all derived layers
+    if (argc > 3 && std::string(argv[1]) == "--import") {
+        Grid g = Grid::loadFromTxt(argv[2]);
+        if (!writeAimap(g, argv[3])) {
+            std::cerr << "Cannot write " << argv[3] << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << argv[3] << " (" << g.w << "x" << g.h << ")" << std::endl;
+        return 0;
+    }
+    // Print the battle recorded by --events as the game printed it
+    if (argc > 2 && std::string(argv[1]) == "--replay") {
+        EventBus bus;
+        ConsoleEventSink console(std::cout);
+        bus.subscribe(console, ConsoleEventSink::kMask);
+        std::string error;
+        if (!replayEventLog(argv[2], bus, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        std::cout << "Replayed " << bus.count() << " events" << std::endl;
+        return 0;
+    }
+    // Seeded load-test map plus a matching scenario:
+    //   --generate <w> <h> [seed] [warriors per team] [out]  ->  out.aimap, out.scenario
+    if (argc > 3 && std::string(argv[1]) == "--generate") {
+        MapGenParams p;
+        p.w = std::atoi(argv[2]);
+        p.h = std::atoi(argv[3]);
+        p.seed = argc > 4 ? (unsigned)std::atoi(argv[4]) : 1u;
+        int warriors = argc > 5 ? std::atoi(argv[5]) : 2;
+        std::string out = argc > 6 ? argv[6] : "generated";
+        if (p.w < 64 || p.h < 64 || p.w > 16384 || p.h > 16384 || warriors < 1) {
+            std::cerr << "Map sides must be 64..16384 and warriors at least 1" << std::endl;
+            return 1;
+        }
+        Grid g = generateMap(p);
+        Grid::buildDerived(g);
+        Scenario s = cornerScenario(g, baseSize(g), warriors);
+        s.map = out.substr(out.find_last_of("/\\") + 1) + ".aimap";
+        if (!writeAimap(g, out + ".aimap") || !saveScenario(s, out + ".scenario")) {
+            std::cerr << "Cannot write " << out << ".aimap / .scenario" << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << out << ".aimap (" << g.w << "x" << g.h << ") and " << out << ".scenario" << std::endl;
+        return 0;
+    }
+
+    // Options before the preset number, in any order:
+    //   --scenario <file>     instead of a preset
+    //   --tune <name>=<value> overrides a tunable after the scenario's own (repeatable)
+    //   --rate <ticks/s>      simulation speed of the graphical or console view, 0 = as fast as possible
+    //   --video <file>        no window: render every tick into a .y4m video (other names: PPM stream)
+    //   --video-size <w>x<h>  frame size for --video
+    //   --trace <file>        Chrome trace of the profiler zones (AI_PROFILE builds)
+    //   --metrics <file>      engine counters as JSON lines, one every kMetricsIntervalMs
+    //   --events <file>       binary log of the game events, for --replay
+    //   --quiet               no battle text on the console
+    std::string scenarioPath, videoPath, tracePath, metricsPath, eventsPath;
+    int videoW = kVideoWidth, videoH = kVideoHeight;
+    std::vector<std::string> tunes;
+    double tickRate = kTickRate;
+    bool quiet = false;
+    while (argc > 1) {
+        std::string opt = argv[1];
+        if (opt == "--quiet") {
+            quiet = true;
+            argv += 1;
+            argc -= 1;
+            continue;
+        }
+        if (argc < 3) break;
+        if (opt == "--scenario") scenarioPath = argv[2];
+        else if (opt == "--tune") tunes.push_back(argv[2]);
+        else if (opt == "--rate") tickRate = std::atof(argv[2]);
+        else if (opt == "--video") videoPath = argv[2];
+        else if (opt == "--trace") tracePath = argv[2];
+        else if (opt == "--metrics") metricsPath = argv[2];
+        else if (opt == "--events") eventsPath = argv[2];
+        else if (opt == "--video-size") {
+            if (std::sscanf(argv[2], "%dx%d", &videoW, &videoH) != 2) {
+                std::cerr << "--video-size expects <width>x<height>, got '" << argv[2] << "'" << std::endl;
+                return 1;
+            }
+        }
+        else break;
+        argv += 2;
+        argc -= 2;
+    }
+
+    if (scenarioPath.empty()) {
+        // Presets: 1=balanced, 2=blue advantage, 3=orange advantage
         int choice;
-        std::cin >> choice;
-        
-        if (choice == 2) {
-            config = GameConfig::BlueAdvantage();
-            std::cout << "\n=== BLUE ADVANTAGE CONFIGURATION ===" << std::endl;
-        } else if (choice == 3) {
-            config = GameConfig::OrangeAdvantage();
-            std::cout << "\n=== ORANGE ADVANTAGE CONFIGURATION ===" << std::endl;
+        if (argc > 1) {
+            choice = std::atoi(argv[1]);
         } else {
-            config = GameConfig::Balanced();
-            std::cout << "\n=== BALANCED CONFIGURATION ===" << std::endl;
+            // Interactive menu
+            std::cout << "\n========== AI BATTLE GAME ==========" << std::endl;
+            std::cout << "Select configuration:" << std::endl;
+            std::cout << "1. Balanced (Equal strength)" << std::endl;
+            std::cout << "2. Blue Advantage (+20 HP, +5 Ammo, +1 Grenade)" << std::endl;
+            std::cout << "3. Orange Advantage (+20 HP, +5 Ammo, +1 Grenade)" << std::endl;
+            std::cout << "Enter choice (1-3): ";
+            std::cin >> choice;
+            std::cout << std::endl;
         }
+        scenarioPath = choice == 2 ? "assets/blue_advantage.scenario"
+                     : choice == 3 ? "assets/orange_advantage.scenario"
+                                   : "assets/balanced.scenario";
     }
-    
-    std::cout << config.name << std::endl;
+
+    Scenario scenario;
+    {
+        std::string error;
+        if (!loadScenario(scenarioPath, scenario, error) || !applyScenarioTunables(scenario, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        for (auto& t : tunes) {
+            auto eq = t.find('=');
+            if (eq == std::string::npos) error = "--tune expects name=value, got '" + t + "'";
+            if (eq == std::string::npos || !applyTunables(t.substr(0, eq), t.substr(eq + 1), error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        }
+    }
+    auto grid=Grid::load(scenario.map);
+    {
+        std::string error;
+        if (!validateScenario(scenario, grid, error)) {
+            std::cerr << "Invalid scenario: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    // Initialize logger
+    g_logger = new Logger("game_log.txt");
+
+    std::cout << "=== " << (scenario.name.empty() ? scenarioPath : scenario.name) << " ===" << std::endl;
     std::cout << "===================================\n" << std::endl;
     
-    auto grid=Grid::loadFromTxt("assets/sample_map_80x50.txt");
-    Game game(grid, config);
+    Game game(grid, scenario);
+    game.setQuiet(quiet);
+    BinaryEventLog eventLog;
+    if (!eventsPath.empty()) {
+        std::string error;
+        if (!eventLog.open(eventsPath, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        game.events.subscribe(eventLog);
+    }
+    int code = 0;
+    if (!metricsPath.empty()) {
+        std::string error;
+        if (!metrics::startDump(metricsPath, kMetricsIntervalMs, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+    if (!videoPath.empty()) {
+        code = runVideo(game, videoPath, videoW, videoH);
+    }
+    else {
 #ifdef USE_CONSOLE
-    std::cout<<"Running CONSOLE fallback. Define USE_CONSOLE off to enable graphics.\n"; runConsole(game);
+        std::cout<<"Running CONSOLE fallback. Define USE_CONSOLE off to enable graphics.\n"; runConsole(game, tickRate);
 #else
-    runGraphics(game);
+        runGraphics(game, tickRate);
 #endif
-    
+        std::cout << "\nGame log saved to: game_log.txt" << std::endl;
+    }
+
+    if (!eventsPath.empty()) {
+        game.events.unsubscribe(eventLog);
+        if (!eventLog.close()) {
+            std::cerr << "Writing " << eventsPath << " failed" << std::endl;
+            code = 1;
+        }
+        else {
+            std::cout << "Events written to " << eventsPath << std::endl;
+        }
+    }
+
+    if (!metricsPath.empty()) {
+        metrics::stopDump();
+        std::cout << "Metrics written to " << metricsPath << std::endl;
+    }
+
+    // Per-zone timings; zones are only recorded in AI_PROFILE builds
+    if (profiler::eventCount() > 0) {
+        profiler::printSummary(std::cout);
+        std::string error;
+        if (!tracePath.empty() && !profiler::writeChromeTrace(tracePath, error)) {
+            std::cerr << error << std::endl;
+            code = 1;
+        }
+        else if (!tracePath.empty()) {
+            std::cout << "Trace written to " << tracePath << " (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+        }
+    }
+    else if (!tracePath.empty()) {
+        std::cerr << "No profiler zones recorded: build with AI_PROFILE defined for --trace" << std::endl;
+    }
+
     // Cleanup logger
-    std::cout << "\nGame log saved to: game_log.txt" << std::endl;
     delete g_logger;
     g_logger = nullptr;
     
-    return 0;
+    return code;
 }